@@ -0,0 +1,82 @@
+// Every worker owns a partition of the data. Sweeps over the partitions are dispatched without a hint and with
+// Affinity::sameAs the partition, which routes each task to the home worker of its partition so the partition stays
+// in that worker's cache.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const partition_size = 1 << 15;
+static size_t const sweep_count = 50;
+
+using Partition = rg::Resource<std::vector<double>>;
+
+auto relax(std::vector<double>& data, int32_t home, uint64_t* onHome) -> rg::Task<void>
+{
+    for(auto& x : data)
+    {
+        x = 0.5 * x + 1.0;
+    }
+    if(rg::ThreadPool::current_worker() == home)
+    {
+        ++*onHome;
+    }
+    co_return;
+}
+
+auto sweeps(std::vector<Partition>& partitions, std::vector<uint64_t>& onHome, bool useAffinity) -> rg::Task<void>
+{
+    for(size_t s = 0; s < sweep_count; ++s)
+    {
+        for(size_t p = 0; p < partitions.size(); ++p)
+        {
+            auto hints = useAffinity ? rg::TaskHints{.affinity = rg::Affinity::sameAs(partitions[p])} : rg::TaskHints{};
+            co_await rg::dispatch_task(
+                hints,
+                relax,
+                partitions[p].rg_write(),
+                static_cast<int32_t>(p),
+                &onHome[p]);
+        }
+    }
+    co_await rg::BarrierAwaiter{};
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+
+    std::vector<Partition> partitions;
+    partitions.reserve(thread_count);
+    for(size_t p = 0; p < thread_count; ++p)
+    {
+        partitions.emplace_back(std::vector<double>(partition_size, 1.0));
+        partitions.back().getUserQueue()->set_home_worker(static_cast<int32_t>(p));
+    }
+
+    std::printf("runs:\n");
+    for(bool useAffinity : {false, true})
+    {
+        std::vector<uint64_t> onHome(thread_count, 0);
+        auto start = std::chrono::steady_clock::now();
+        rg::submit(pool, sweeps, std::ref(partitions), std::ref(onHome), useAffinity).get();
+        auto duration
+            = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        uint64_t total = 0;
+        for(auto count : onHome)
+        {
+            total += count;
+        }
+        std::printf("  - affinity: %s\n", useAffinity ? "same_as_partition" : "none");
+        std::printf("    duration: %" PRIu64 " us\n", duration.count());
+        std::printf("    on_home: %" PRIu64 " / %" PRIu64 "\n", total, sweep_count * thread_count);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// A latency arena and a batch arena share the process. Batch work is submitted while the latency arena only serves
+// a few probes. The run is repeated with the batch arena allowed to borrow the idle latency workers, which should
+// shorten the batch without a noticeable effect on the probes.
+
+#include <rg.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const batch_count = 64;
+static size_t const batch_n = 22;
+static size_t const probe_count = 100;
+
+using Clock = std::chrono::steady_clock;
+
+auto fib(size_t n) -> rg::Task<size_t>
+{
+    if(n < 2)
+    {
+        co_return n;
+    }
+    auto a = co_await rg::dispatch_task(fib, n - 1);
+    auto b = co_await rg::dispatch_task(fib, n - 2);
+    co_return co_await a.get() + co_await b.get();
+}
+
+auto probe() -> rg::Task<int>
+{
+    co_return 1;
+}
+
+struct RunResult
+{
+    Clock::duration batch{};
+    Clock::duration probeMax{};
+};
+
+RunResult run(rg::Arenas& arenas)
+{
+    RunResult result;
+    auto start = Clock::now();
+    std::vector<rg::SubmitHandle<size_t>> batch;
+    batch.reserve(batch_count);
+    for(size_t i = 0; i < batch_count; ++i)
+    {
+        batch.push_back(arenas.submit("batch", fib, batch_n));
+    }
+    for(size_t i = 0; i < probe_count; ++i)
+    {
+        auto probeStart = Clock::now();
+        arenas.submit("latency", rg::TaskHints{rg::Priority::High}, probe).get();
+        result.probeMax = std::max(result.probeMax, Clock::now() - probeStart);
+    }
+    for(auto& handle : batch)
+    {
+        if(handle.get() != 17'711)
+        {
+            std::printf("ERROR: wrong result\n");
+        }
+    }
+    result.batch = Clock::now() - start;
+    return result;
+}
+
+int main()
+{
+    auto const arenaSize = std::max<size_t>(thread_count / 2, 1);
+    std::printf("threads: %" PRIu64 "\n", 2 * arenaSize);
+
+    rg::Arenas arenas;
+    arenas.create("latency", arenaSize);
+    arenas.create("batch", arenaSize);
+    run(arenas); // warmup
+
+    auto isolated = run(arenas);
+    arenas.lend("latency", "batch", static_cast<uint32_t>(arenaSize));
+    auto borrowing = run(arenas);
+
+    auto toUs = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::printf("runs:\n");
+    std::printf("  - borrow_quota: 0\n");
+    std::printf("    duration: %" PRIu64 " us\n", toUs(isolated.batch));
+    std::printf("    probe_max: %" PRIu64 " us\n", toUs(isolated.probeMax));
+    std::printf("  - borrow_quota: %" PRIu64 "\n", arenaSize);
+    std::printf("    duration: %" PRIu64 " us\n", toUs(borrowing.batch));
+    std::printf("    probe_max: %" PRIu64 " us\n", toUs(borrowing.probeMax));
+    return 0;
+}
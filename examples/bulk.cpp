@@ -0,0 +1,107 @@
+// A skynet style tree with a fan-out of 10 at every level, spawned once with a dispatch_task per child and once with
+// one dispatch_bulk per node. Both runs compute the same sum, the bulk run should spend less time per child.
+
+#include <rg.hpp>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const depth_max = 6;
+static size_t const fan_out = 10;
+
+using Clock = std::chrono::steady_clock;
+
+size_t depthOffset(size_t depth)
+{
+    size_t offset = 1;
+    for(size_t i = 0; i < depth_max - depth - 1; ++i)
+    {
+        offset *= fan_out;
+    }
+    return offset;
+}
+
+auto loopNode(size_t base, size_t depth) -> rg::Task<size_t>
+{
+    if(depth == depth_max)
+    {
+        co_return base;
+    }
+    auto const offset = depthOffset(depth);
+    std::array<rg::Task<size_t>, fan_out> children;
+    for(size_t idx = 0; idx < fan_out; ++idx)
+    {
+        children[idx] = co_await rg::dispatch_task(loopNode, base + offset * idx, depth + 1);
+    }
+    size_t count = 0;
+    for(auto& child : children)
+    {
+        count += co_await child.get();
+    }
+    co_return count;
+}
+
+auto bulkNode(size_t base, size_t depth) -> rg::Task<size_t>
+{
+    if(depth == depth_max)
+    {
+        co_return base;
+    }
+    auto const offset = depthOffset(depth);
+    auto children = co_await rg::dispatch_bulk(
+        fan_out,
+        [](size_t idx, size_t base, size_t offset, size_t depth) { return bulkNode(base + offset * idx, depth); },
+        base,
+        offset,
+        depth + 1);
+    size_t count = 0;
+    for(auto& child : children)
+    {
+        count += co_await child.get();
+    }
+    co_return count;
+}
+
+template<typename Node>
+auto run(Node node, size_t* result) -> rg::Task<void>
+{
+    auto root = co_await rg::dispatch_task(node, 0, 0);
+    *result = co_await root.get();
+    co_return;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+
+    size_t expected = 0;
+    rg::submit(pool, run<decltype(&loopNode)>, &loopNode, &expected).wait(); // warmup
+
+    std::printf("runs:\n");
+    for(bool bulk : {false, true})
+    {
+        size_t result = 0;
+        auto start = Clock::now();
+        if(bulk)
+        {
+            rg::submit(pool, run<decltype(&bulkNode)>, &bulkNode, &result).wait();
+        }
+        else
+        {
+            rg::submit(pool, run<decltype(&loopNode)>, &loopNode, &result).wait();
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        if(result != expected)
+        {
+            std::printf("ERROR: wrong result - %" PRIu64 "\n", result);
+        }
+        std::printf("  - dispatch: %s\n", bulk ? "bulk" : "loop");
+        std::printf("    duration: %" PRIu64 " us\n", duration.count());
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Per-task cost of dispatching tiny tasks, as coroutines with dispatch_task and as plain calls with dispatch_call.
+// Both push every child to the pool, once without resources and once with a write to one of a few resources.
+
+#include <rg.hpp>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+// a resource node holds at most 1024 accesses over its lifetime, stay below that per resource
+static size_t const resource_count = 256;
+static size_t const task_count = resource_count * 1000;
+
+using Clock = std::chrono::steady_clock;
+
+static rg::TaskHints const pushHints{rg::Priority::Normal, rg::SpawnPolicy::ChildStealing, {}};
+
+void bump(uint64_t* slot, uint64_t value)
+{
+    *slot += value;
+}
+
+auto bumpTask(uint64_t* slot, uint64_t value) -> rg::Task<void>
+{
+    *slot += value;
+    co_return;
+}
+
+void bumpResource(uint64_t& slot, uint64_t value)
+{
+    slot += value;
+}
+
+auto bumpResourceTask(uint64_t& slot, uint64_t value) -> rg::Task<void>
+{
+    slot += value;
+    co_return;
+}
+
+auto run(bool plain, bool resources, uint64_t* result) -> rg::Task<void>
+{
+    std::array<rg::Resource<uint64_t>, resource_count> slots;
+    std::array<uint64_t, resource_count> plainSlots{};
+    for(size_t i = 0; i < task_count; ++i)
+    {
+        auto slot = i % resource_count;
+        if(resources && plain)
+        {
+            co_await rg::dispatch_call(pushHints, bumpResource, slots[slot].rg_write(), i);
+        }
+        else if(resources)
+        {
+            co_await rg::dispatch_task(pushHints, bumpResourceTask, slots[slot].rg_write(), i);
+        }
+        else if(plain)
+        {
+            co_await rg::dispatch_call(pushHints, bump, &plainSlots[slot], i);
+        }
+        else
+        {
+            co_await rg::dispatch_task(pushHints, bumpTask, &plainSlots[slot], i);
+        }
+    }
+    co_await rg::BarrierAwaiter{};
+    uint64_t sum = 0;
+    for(size_t i = 0; i < resource_count; ++i)
+    {
+        sum += resources ? slots[i].get() : plainSlots[i];
+    }
+    *result = sum;
+    co_return;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+    uint64_t const expected = task_count * (task_count - 1) / 2;
+
+    std::printf("runs:\n");
+    for(bool resources : {false, true})
+    {
+        for(bool plain : {false, true})
+        {
+            uint64_t result = 0;
+            auto start = Clock::now();
+            rg::submit(pool, run, plain, resources, &result).wait();
+            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+            if(result != expected)
+            {
+                std::printf("ERROR: wrong result - %" PRIu64 "\n", result);
+            }
+            std::printf("  - dispatch: %s\n", plain ? "call" : "task");
+            std::printf("    resources: %s\n", resources ? "true" : "false");
+            std::printf("    duration: %" PRIu64 " us\n", static_cast<uint64_t>(duration.count() / 1000));
+            std::printf("    per_task: %" PRIu64 " ns\n", static_cast<uint64_t>(duration.count()) / task_count);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// An elastic pool follows a load that alternates between bursts of work and a trickle of small requests. The worker
+// count should grow during the bursts and shrink back towards the minimum in between. A fixed pool is then resized
+// by hand with set_worker_count.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const burst_count = 32;
+static size_t const burst_n = 20;
+static size_t const trickle_count = 200;
+static auto const trickle_gap = std::chrono::microseconds(500);
+
+using Clock = std::chrono::steady_clock;
+
+auto fib(size_t n) -> rg::Task<size_t>
+{
+    if(n < 2)
+    {
+        co_return n;
+    }
+    auto a = co_await rg::dispatch_task(fib, n - 1);
+    auto b = co_await rg::dispatch_task(fib, n - 2);
+    co_return co_await a.get() + co_await b.get();
+}
+
+void burst(rg::ThreadPool* pool)
+{
+    std::vector<rg::SubmitHandle<size_t>> handles;
+    handles.reserve(burst_count);
+    for(size_t i = 0; i < burst_count; ++i)
+    {
+        handles.push_back(rg::submit(pool, fib, burst_n));
+    }
+    for(auto& handle : handles)
+    {
+        if(handle.get() != 6'765)
+        {
+            std::printf("ERROR: wrong result\n");
+        }
+    }
+}
+
+void trickle(rg::ThreadPool* pool)
+{
+    for(size_t i = 0; i < trickle_count; ++i)
+    {
+        rg::submit(pool, fib, 2).get();
+        std::this_thread::sleep_for(trickle_gap);
+    }
+}
+
+// runs a phase and reports how long it took and how many workers were active at its end
+template<typename Phase>
+void phase(char const* name, rg::ThreadPool* pool, Phase&& run)
+{
+    auto start = Clock::now();
+    run(pool);
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    std::printf("  - phase: %s\n", name);
+    std::printf("    duration: %" PRIu64 " us\n", duration.count());
+    std::printf("    workers: %" PRIu64 "\n", pool->worker_count());
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+
+    rg::PoolOptions options;
+    options.minWorkers = 1;
+    auto poolObj = rg::init(thread_count, options);
+    auto* pool = poolObj.pool_ptr();
+
+    std::printf("runs:\n");
+    phase("trickle", pool, trickle);
+    phase("burst", pool, burst);
+    phase("trickle", pool, trickle);
+    phase("burst", pool, burst);
+
+    // a fixed pool only changes its worker count when told to
+    auto fixedObj = rg::init(thread_count);
+    auto* fixed = fixedObj.pool_ptr();
+    fixed->set_worker_count(1);
+    phase("burst_one_worker", fixed, burst);
+    fixed->set_worker_count(fixed->max_worker_count());
+    phase("burst_all_workers", fixed, burst);
+    return 0;
+}
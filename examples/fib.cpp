@@ -7,7 +7,7 @@
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static size_t const iter_count = 1;
 
-inline auto fib(size_t n) -> rg::Task<size_t>
+inline auto fib(size_t n) -> rg::LightTask<size_t>
 {
     if(n < 2)
     {
@@ -19,10 +19,11 @@ inline auto fib(size_t n) -> rg::Task<size_t>
     co_return co_await a.get() + b;
 };
 
-auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr, size_t n) -> rg::InitTask<int>
+auto main_wrapper(rg::ThreadPool* ptr, size_t n) -> rg::InitTask<int>
 {
     co_await rg::dispatch_task(fib, 30);
     co_await rg::BarrierAwaiter{};
+    ptr->reset_stats();
     std::printf("results:\n");
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -38,21 +39,42 @@ auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr, size_t n) -> rg::InitTas
     std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
     std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
 
+    if constexpr(rg::statsEnabled)
+    {
+        auto stats = ptr->stats();
+        std::printf("stats:\n");
+        for(auto const& worker : stats.workers)
+        {
+            std::printf("  - tasks_resumed: %" PRIu64 "\n", worker.tasks_resumed);
+            std::printf("    tasks_pushed: %" PRIu64 "\n", worker.tasks_pushed);
+            std::printf("    tasks_inlined: %" PRIu64 "\n", worker.tasks_inlined);
+            std::printf("    steal_attempts: %" PRIu64 "\n", worker.steal_attempts);
+            std::printf("    steals: %" PRIu64 "\n", worker.steals);
+            std::printf("    stolen_items: %" PRIu64 "\n", worker.stolen_items);
+            std::printf("    steal_time: %" PRIu64 " us\n", worker.steal_time.count() / 1000);
+            std::printf("    parks: %" PRIu64 "\n", worker.parks);
+            std::printf("    deque_high_water: %" PRIu64 "\n", worker.deque_high_water);
+        }
+    }
+
     co_return 0;
 }
 
 int main(int argc, char* argv[])
 {
-    if(argc != 2)
+    auto policy = argc == 3 ? rg::spawnPolicyFromString(argv[2]) : rg::SpawnPolicy::ContinuationStealing;
+    if(argc < 2 || argc > 3 || !policy || policy == rg::SpawnPolicy::PoolDefault)
     {
-        printf("Usage: fib <n-th fibonacci number requested>\n");
+        printf("Usage: fib <n-th fibonacci number requested> [continuation|child|adaptive]\n");
         exit(0);
     }
     auto n = static_cast<size_t>(atoi(argv[1]));
 
     std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("policy: %.*s\n", static_cast<int>(rg::toString(*policy).size()), rg::toString(*policy).data());
 
     auto poolObj = rg::init(thread_count);
+    poolObj.pool_ptr()->set_spawn_policy(*policy);
     auto a = main_wrapper(poolObj.pool_ptr(), n);
 
     return 0;
@@ -0,0 +1,97 @@
+// Measures the cost of an idle pool and how quickly a parked worker picks up new work.
+// idle:   cpu time the process burns while the pool has nothing to do
+// wakeup: time from pushing a continuation until a sleeping worker has stolen and resumed it
+
+#include <rg.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const iter_count = 100;
+static auto const idle_duration = std::chrono::milliseconds(500);
+static auto const park_duration = std::chrono::milliseconds(2);
+
+using Clock = std::chrono::steady_clock;
+
+std::chrono::microseconds cpu_time()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto to_us = [](timeval const& t)
+    { return std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec); };
+    return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+// occupies the worker until the continuation of the dispatching task has been stolen
+auto spin_until_stolen(std::atomic<bool>* stolen) -> rg::Task<int>
+{
+    while(!stolen->load(std::memory_order_acquire))
+    {
+    }
+    co_return 0;
+}
+
+auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
+{
+    Clock::duration total{};
+    Clock::duration worst{};
+
+    for(size_t i = 0; i < iter_count; ++i)
+    {
+        // give the other workers time to park
+        std::this_thread::sleep_for(park_duration);
+
+        std::atomic<bool> stolen{false};
+        auto start = Clock::now();
+        // work first: this worker runs the child, the continuation has to be picked up by a parked worker
+        auto child = co_await rg::dispatch_task(spin_until_stolen, &stolen);
+        auto latency = Clock::now() - start;
+        stolen.store(true, std::memory_order_release);
+        co_await child.get();
+
+        total += latency;
+        worst = std::max(worst, latency);
+    }
+
+    auto toUs = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::printf("wakeup:\n");
+    std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+    std::printf("    mean_latency: %" PRIu64 " us\n", toUs(total / iter_count));
+    std::printf("    max_latency: %" PRIu64 " us\n", toUs(worst));
+    co_return 0;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    if(thread_count < 2)
+    {
+        std::printf("error: needs at least 2 threads\n");
+        return 1;
+    }
+
+    auto poolObj = rg::init(thread_count);
+
+    // nothing has been dispatched, every worker is idle
+    auto cpuStart = cpu_time();
+    auto wallStart = Clock::now();
+    std::this_thread::sleep_for(idle_duration);
+    auto cpuUs = (cpu_time() - cpuStart).count();
+    auto wallUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - wallStart).count();
+
+    std::printf("idle:\n");
+    std::printf("  - duration: %" PRIu64 " us\n", wallUs);
+    std::printf("    cpu_time: %" PRIu64 " us\n", cpuUs);
+    std::printf("    busy_cores: %.3f\n", static_cast<double>(cpuUs) / static_cast<double>(wallUs));
+
+    auto a = main_wrapper(poolObj.pool_ptr());
+
+    return 0;
+}
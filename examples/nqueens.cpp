@@ -23,7 +23,7 @@ void check_answer(int result)
 }
 
 template<size_t N>
-auto nqueens(int xMax, std::array<char, N> buf) -> rg::Task<int>
+auto nqueens(int xMax, std::array<char, N> buf) -> rg::LightTask<int>
 {
     if(N == xMax)
     {
@@ -50,7 +50,7 @@ auto nqueens(int xMax, std::array<char, N> buf) -> rg::Task<int>
 
     // Spawn up to N tasks (but possibly less, if queens_ok fails)
 
-    std::array<rg::Task<int>, N> parts;
+    std::array<rg::LightTask<int>, N> parts;
     for([[maybe_unused]] auto t : tasks)
     {
         parts[taskCount] = co_await rg::dispatch_task(nqueens<N>, xMax + 1, buf);
@@ -94,11 +94,20 @@ auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
     co_return 0;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    auto policy = argc == 2 ? rg::spawnPolicyFromString(argv[1]) : rg::SpawnPolicy::ContinuationStealing;
+    if(argc > 2 || !policy || policy == rg::SpawnPolicy::PoolDefault)
+    {
+        printf("Usage: nqueens [continuation|child|adaptive]\n");
+        exit(0);
+    }
+
     std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("policy: %.*s\n", static_cast<int>(rg::toString(*policy).size()), rg::toString(*policy).data());
 
     auto poolObj = rg::init(thread_count);
+    poolObj.pool_ptr()->set_spawn_policy(*policy);
     auto a = main_wrapper(poolObj.pool_ptr());
 
     return 0;
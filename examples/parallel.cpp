@@ -0,0 +1,184 @@
+// The parallel algorithms of rg against serial STL and, when TBB is found, against std::execution::par. Every run
+// starts from the same input and is checked against the serial result.
+
+#include <rg.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <vector>
+#ifdef RG_BENCH_STD_PAR
+#    include <execution>
+#endif
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const element_count = size_t{1} << 22;
+
+using Clock = std::chrono::steady_clock;
+using Data = std::vector<uint64_t>;
+
+enum class Impl
+{
+    Serial,
+    Rg,
+    StdPar,
+};
+
+inline constexpr std::string_view implNames[] = {"serial", "rg", "std_par"};
+
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 31;
+    x *= 0x7fb5'd329'728e'a185;
+    return x ^ (x >> 27);
+}
+
+// runs one algorithm in place on data or from data to out. Returns the sum of reduce, 0 for the others
+uint64_t runAlgorithm(std::string_view algorithm, Impl impl, Data& data, Data& out, rg::ThreadPool* pool)
+{
+    auto const policy = rg::execution::par(pool);
+    if(algorithm == "for_each")
+    {
+        auto f = [](uint64_t& x) { x = mix(x); };
+        switch(impl)
+        {
+        case Impl::Serial:
+            std::for_each(data.begin(), data.end(), f);
+            break;
+        case Impl::Rg:
+            rg::for_each(policy, data.begin(), data.end(), f);
+            break;
+        case Impl::StdPar:
+#ifdef RG_BENCH_STD_PAR
+            std::for_each(std::execution::par, data.begin(), data.end(), f);
+#endif
+            break;
+        }
+        return 0;
+    }
+    if(algorithm == "transform")
+    {
+        auto op = [](uint64_t x) { return mix(x) + 1; };
+        switch(impl)
+        {
+        case Impl::Serial:
+            std::transform(data.begin(), data.end(), out.begin(), op);
+            break;
+        case Impl::Rg:
+            rg::transform(policy, data.begin(), data.end(), out.begin(), op);
+            break;
+        case Impl::StdPar:
+#ifdef RG_BENCH_STD_PAR
+            std::transform(std::execution::par, data.begin(), data.end(), out.begin(), op);
+#endif
+            break;
+        }
+        return 0;
+    }
+    if(algorithm == "reduce")
+    {
+        uint64_t sum = 0;
+        switch(impl)
+        {
+        case Impl::Serial:
+            sum = std::reduce(data.begin(), data.end(), uint64_t{0});
+            break;
+        case Impl::Rg:
+            sum = rg::reduce(policy, data.begin(), data.end(), uint64_t{0});
+            break;
+        case Impl::StdPar:
+#ifdef RG_BENCH_STD_PAR
+            sum = std::reduce(std::execution::par, data.begin(), data.end(), uint64_t{0});
+#endif
+            break;
+        }
+        return sum;
+    }
+    if(algorithm == "inclusive_scan")
+    {
+        switch(impl)
+        {
+        case Impl::Serial:
+            std::inclusive_scan(data.begin(), data.end(), out.begin());
+            break;
+        case Impl::Rg:
+            rg::inclusive_scan(policy, data.begin(), data.end(), out.begin());
+            break;
+        case Impl::StdPar:
+#ifdef RG_BENCH_STD_PAR
+            std::inclusive_scan(std::execution::par, data.begin(), data.end(), out.begin());
+#endif
+            break;
+        }
+        return 0;
+    }
+    switch(impl)
+    {
+    case Impl::Serial:
+        std::sort(data.begin(), data.end());
+        break;
+    case Impl::Rg:
+        rg::sort(policy, data.begin(), data.end());
+        break;
+    case Impl::StdPar:
+#ifdef RG_BENCH_STD_PAR
+        std::sort(std::execution::par, data.begin(), data.end());
+#endif
+        break;
+    }
+    return 0;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("elements: %" PRIu64 "\n", element_count);
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+
+    Data input(element_count);
+    std::mt19937_64 rng{42};
+    std::generate(input.begin(), input.end(), [&] { return rng() >> 24; });
+
+#ifdef RG_BENCH_STD_PAR
+    auto const impls = {Impl::Serial, Impl::Rg, Impl::StdPar};
+#else
+    auto const impls = {Impl::Serial, Impl::Rg};
+#endif
+
+    std::printf("runs:\n");
+    for(std::string_view algorithm : {"for_each", "transform", "reduce", "inclusive_scan", "sort"})
+    {
+        Data expectedData;
+        Data expectedOut;
+        uint64_t expectedSum = 0;
+        for(auto impl : impls)
+        {
+            Data data = input;
+            Data out(element_count);
+            auto start = Clock::now();
+            auto sum = runAlgorithm(algorithm, impl, data, out, pool);
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+            if(impl == Impl::Serial)
+            {
+                expectedData = std::move(data);
+                expectedOut = std::move(out);
+                expectedSum = sum;
+            }
+            else if(data != expectedData || out != expectedOut || sum != expectedSum)
+            {
+                std::printf("ERROR: wrong result\n");
+            }
+            auto name = implNames[static_cast<size_t>(impl)];
+            std::printf("  - algorithm: %.*s\n", static_cast<int>(algorithm.size()), algorithm.data());
+            std::printf("    impl: %.*s\n", static_cast<int>(name.size()), name.data());
+            std::printf("    duration: %" PRIu64 " us\n", duration.count());
+        }
+    }
+    return 0;
+}
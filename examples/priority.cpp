@@ -0,0 +1,77 @@
+// Two identical task trees compete for the pool, one dispatched in the background class and one in the high class
+// right after it. Continuations are pushed in the class of their task, so the workers should finish the high tree
+// first even though it started later.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const leaf_count = 20'000;
+static auto const leaf_work = std::chrono::microseconds(20);
+
+using Clock = std::chrono::steady_clock;
+
+auto leaf() -> rg::Task<int>
+{
+    auto end = Clock::now() + leaf_work;
+    while(Clock::now() < end)
+    {
+    }
+    co_return 1;
+}
+
+// spawns the leaves in its own class, returns when all of them are done
+auto tree(rg::Priority priority, Clock::time_point start, Clock::duration* duration) -> rg::Task<void>
+{
+    std::vector<rg::Task<int>> leaves;
+    leaves.reserve(leaf_count);
+    for(size_t i = 0; i < leaf_count; ++i)
+    {
+        leaves.push_back(co_await rg::dispatch_task(rg::TaskHints{priority}, leaf));
+    }
+    for(auto& task : leaves)
+    {
+        co_await task.get();
+    }
+    *duration = Clock::now() - start;
+    co_return;
+}
+
+auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
+{
+    Clock::duration background{};
+    Clock::duration high{};
+    auto start = Clock::now();
+    co_await rg::dispatch_task(
+        rg::TaskHints{rg::Priority::Background},
+        tree,
+        rg::Priority::Background,
+        start,
+        &background);
+    co_await rg::dispatch_task(rg::TaskHints{rg::Priority::High}, tree, rg::Priority::High, start, &high);
+    co_await rg::BarrierAwaiter{};
+
+    auto toUs = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::printf("runs:\n");
+    std::printf("  - priority: background\n");
+    std::printf("    leaf_count: %" PRIu64 "\n", leaf_count);
+    std::printf("    duration: %" PRIu64 " us\n", toUs(background));
+    std::printf("  - priority: high\n");
+    std::printf("    leaf_count: %" PRIu64 "\n", leaf_count);
+    std::printf("    duration: %" PRIu64 " us\n", toUs(high));
+    co_return 0;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+
+    auto poolObj = rg::init(thread_count);
+    auto a = main_wrapper(poolObj.pool_ptr());
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Records the steal decisions of a fib run with fixed seeds and replays them in a fresh pool. Pass a file name to keep
+// the trace, or to replay a trace recorded earlier, e.g. on another machine.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const fib_n = 25;
+static uint32_t const seed = 42;
+
+auto fib(size_t n) -> rg::Task<size_t>
+{
+    if(n < 2)
+    {
+        co_return n;
+    }
+    auto a = co_await rg::dispatch_task(fib, n - 1);
+    auto b = co_await rg::dispatch_task(fib, n - 2);
+    co_return co_await a.get() + co_await b.get();
+}
+
+// runs fib once on a new pool and returns its trace
+rg::SchedulerTrace run(char const* mode, rg::PoolOptions const& options)
+{
+    auto poolObj = rg::init(thread_count, options);
+    auto* pool = poolObj.pool_ptr();
+    auto start = std::chrono::steady_clock::now();
+    if(rg::submit(pool, fib, fib_n).get() != 75'025)
+    {
+        std::printf("ERROR: wrong result\n");
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    // stop the workers so the trace is complete
+    pool->shutdown();
+
+    auto trace = pool->trace();
+    auto sum = [&](auto member)
+    {
+        return std::accumulate(
+            trace.workers.begin(),
+            trace.workers.end(),
+            uint64_t{0},
+            [member](uint64_t total, rg::WorkerTrace const& worker) { return total + member(worker); });
+    };
+    std::printf("  - mode: %s\n", mode);
+    std::printf("    duration: %" PRIu64 " us\n", duration.count());
+    std::printf("    steals: %" PRIu64 "\n", sum([](auto const& worker) { return worker.steals.size(); }));
+    std::printf("    diverged: %" PRIu64 "\n", sum([](auto const& worker) { return worker.diverged; }));
+    return trace;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc > 2)
+    {
+        printf("Usage: replay [trace file]\n");
+        exit(0);
+    }
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("runs:\n");
+
+    rg::PoolOptions options;
+    options.recordTrace = true;
+    std::shared_ptr<rg::SchedulerTrace const> recorded;
+    if(std::ifstream in; argc == 2 && (in.open(argv[1]), in))
+    {
+        recorded = std::make_shared<rg::SchedulerTrace const>(rg::SchedulerTrace::load(in));
+    }
+    else
+    {
+        options.seed = seed;
+        recorded = std::make_shared<rg::SchedulerTrace const>(run("record", options));
+        if(argc == 2)
+        {
+            std::ofstream out(argv[1]);
+            recorded->save(out);
+        }
+    }
+
+    options.replayTrace = recorded;
+    run("replay", options);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Results handed out by tasks: move-only results without a default constructor, large results that are moved and not
+// copied out of the frame, and SlotTasks that are held while later tasks wait for the resource they wrote.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const task_count = 1000;
+static size_t const block_size = 1 << 16;
+// a resource node holds at most 1024 accesses over its lifetime
+static size_t const chain_length = 1000;
+
+using Clock = std::chrono::steady_clock;
+
+// move-only and not default constructible
+struct Block
+{
+    std::unique_ptr<uint64_t[]> data;
+    size_t size;
+
+    explicit Block(size_t n) : data{std::make_unique<uint64_t[]>(n)}, size{n}
+    {
+    }
+};
+
+auto makeBlock(uint64_t value) -> rg::LightTask<Block>
+{
+    Block block{block_size};
+    std::fill_n(block.data.get(), block.size, value);
+    co_return block;
+}
+
+auto makeVector(uint64_t value) -> rg::LightTask<std::vector<uint64_t>>
+{
+    co_return std::vector<uint64_t>(block_size, value);
+}
+
+auto blocks(uint64_t* sum) -> rg::LightTask<void>
+{
+    for(size_t i = 0; i < task_count; ++i)
+    {
+        auto task = co_await rg::dispatch_task(makeBlock, i);
+        auto block = co_await task.get();
+        *sum += block.data[block.size - 1];
+    }
+    co_return;
+}
+
+auto vectors(uint64_t* sum) -> rg::LightTask<void>
+{
+    for(size_t i = 0; i < task_count; ++i)
+    {
+        auto values = co_await rg::dispatch_task<true, true>(makeVector, i);
+        *sum += values.back();
+    }
+    co_return;
+}
+
+// every link writes the counter, the next one only runs once the frame of this one is gone
+auto chainLink(uint64_t& counter) -> rg::SlotTask<uint64_t>
+{
+    co_return ++counter;
+}
+
+auto chain(uint64_t* sum) -> rg::LightTask<void>
+{
+    rg::Resource<uint64_t> counter;
+    // held until the end. Held Tasks would keep their frames and block the counter for the links after them
+    std::vector<rg::SlotTask<uint64_t>> links;
+    links.reserve(chain_length);
+    for(size_t i = 0; i < chain_length; ++i)
+    {
+        links.push_back(co_await rg::dispatch_task(chainLink, counter.rg_write()));
+    }
+    for(auto& task : links)
+    {
+        *sum += co_await task.get();
+    }
+    co_return;
+}
+
+template<typename Run>
+void measure(char const* name, rg::ThreadPool* pool, uint64_t expected, Run run)
+{
+    uint64_t sum = 0;
+    auto start = Clock::now();
+    rg::submit(pool, run, &sum).wait();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    if(sum != expected)
+    {
+        std::printf("ERROR: wrong result - %" PRIu64 "\n", sum);
+    }
+    std::printf("  - results: %s\n", name);
+    std::printf("    duration: %" PRIu64 " us\n", static_cast<uint64_t>(duration.count()));
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+    uint64_t const rangeSum = task_count * (task_count - 1) / 2;
+
+    std::printf("runs:\n");
+    measure("move_only", pool, rangeSum, blocks);
+    measure("moved_vector", pool, rangeSum, vectors);
+    measure("slot_chain", pool, chain_length * (chain_length + 1) / 2, chain);
+    return 0;
+}
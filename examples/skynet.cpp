@@ -12,7 +12,7 @@ static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static size_t const iter_count = 1;
 
 template<size_t DepthMax>
-rg::Task<size_t> skynet_one(size_t BaseNum, size_t Depth)
+rg::LightTask<size_t> skynet_one(size_t BaseNum, size_t Depth)
 {
     if(Depth == DepthMax)
     {
@@ -24,7 +24,7 @@ rg::Task<size_t> skynet_one(size_t BaseNum, size_t Depth)
         depthOffset *= 10;
     }
 
-    std::array<rg::Task<size_t>, 10> children;
+    std::array<rg::LightTask<size_t>, 10> children;
     for(size_t idx = 0; idx < 10; ++idx)
     {
         children[idx] = co_await rg::dispatch_task(skynet_one<DepthMax>, BaseNum + depthOffset * idx, Depth + 1);
@@ -39,7 +39,7 @@ rg::Task<size_t> skynet_one(size_t BaseNum, size_t Depth)
 }
 
 template<size_t DepthMax>
-rg::Task<void> skynet()
+rg::LightTask<void> skynet()
 {
     auto handle = co_await rg::dispatch_task(skynet_one<DepthMax>, 0, 0);
     size_t count = co_await handle.get();
@@ -51,7 +51,7 @@ rg::Task<void> skynet()
 }
 
 template<size_t Depth = 6>
-rg::Task<void> loop_skynet()
+rg::LightTask<void> loop_skynet()
 {
     std::printf("runs:\n");
     auto startTime = std::chrono::high_resolution_clock::now();
@@ -75,11 +75,20 @@ auto main_wrapper([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
     co_return 0;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    auto policy = argc == 2 ? rg::spawnPolicyFromString(argv[1]) : rg::SpawnPolicy::ContinuationStealing;
+    if(argc > 2 || !policy || policy == rg::SpawnPolicy::PoolDefault)
+    {
+        printf("Usage: skynet [continuation|child|adaptive]\n");
+        exit(0);
+    }
+
     std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("policy: %.*s\n", static_cast<int>(rg::toString(*policy).size()), rg::toString(*policy).data());
 
     auto poolObj = rg::init(thread_count);
+    poolObj.pool_ptr()->set_spawn_policy(*policy);
     auto a = main_wrapper(poolObj.pool_ptr());
 
     return 0;
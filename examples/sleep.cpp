@@ -0,0 +1,65 @@
+// Many tasks wait for a millisecond each, once blocking their worker with std::this_thread::sleep_for and once
+// suspended in the timer wheel with co_await rg::sleep_for. Blocking sleeps take turns on the workers, suspended
+// sleeps overlap, so the second run should finish in about one sleep. late_max is the worst oversleep of a task.
+
+#include <rg.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const task_count = 1'000;
+static auto const sleep_duration = std::chrono::milliseconds(1);
+
+using Clock = std::chrono::steady_clock;
+
+auto sleeper(bool suspend, std::atomic<int64_t>* lateMax) -> rg::Task<void>
+{
+    auto const deadline = Clock::now() + sleep_duration;
+    if(suspend)
+    {
+        co_await rg::sleep_until(deadline);
+    }
+    else
+    {
+        std::this_thread::sleep_until(deadline);
+    }
+    auto const late = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count();
+    auto seen = lateMax->load(std::memory_order_relaxed);
+    while(seen < late && !lateMax->compare_exchange_weak(seen, late, std::memory_order_relaxed))
+    {
+    }
+    co_return;
+}
+
+auto run(bool suspend, std::atomic<int64_t>* lateMax) -> rg::Task<void>
+{
+    for(size_t i = 0; i < task_count; ++i)
+    {
+        co_await rg::dispatch_task(sleeper, suspend, lateMax);
+    }
+    co_await rg::BarrierAwaiter{};
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    auto poolObj = rg::init(thread_count);
+
+    std::printf("runs:\n");
+    for(bool suspend : {false, true})
+    {
+        std::atomic<int64_t> lateMax{0};
+        auto start = Clock::now();
+        rg::submit(poolObj.pool_ptr(), run, suspend, &lateMax).wait();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        std::printf("  - sleep: %s\n", suspend ? "suspend" : "block");
+        std::printf("    duration: %" PRIu64 " us\n", duration.count());
+        std::printf("    late_max: %" PRId64 " us\n", lateMax.load());
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Microbenchmark for riften::Deque::steal against steal_batch.
+// One deque is filled up front and a number of thieves drain it. Single thieves visit the victim once per item,
+// batch thieves move up to half of the victim into their own deque, pop from there and can be stolen from.
+// Afterwards a burst on a single deque checks that the buffer shrinks back to its initial capacity.
+
+#include <dequeue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const item_count = 1'000'000;
+static int64_t const batch_size = 32;
+
+using Deque = riften::Deque<std::uintptr_t>;
+
+struct Result
+{
+    std::chrono::microseconds duration;
+    uint64_t victim_visits;
+};
+
+template<bool Batch>
+Result drain(size_t thieves)
+{
+    Deque victim(1024);
+    for(std::uintptr_t i = 0; i < item_count; ++i)
+    {
+        victim.emplace(i);
+    }
+
+    std::vector<std::unique_ptr<Deque>> locals;
+    for(size_t t = 0; t < thieves; ++t)
+    {
+        locals.push_back(std::make_unique<Deque>(1024));
+    }
+
+    std::atomic<size_t> consumed{0};
+    std::atomic<uint64_t> visits{0};
+    std::atomic<bool> start{false};
+
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < thieves; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                while(!start.load(std::memory_order_acquire))
+                {
+                }
+                uint64_t myVisits = 0;
+                while(consumed.load(std::memory_order_relaxed) < item_count)
+                {
+                    std::optional<std::uintptr_t> item;
+                    if constexpr(Batch)
+                    {
+                        item = locals[t]->pop();
+                        if(!item)
+                        {
+                            ++myVisits;
+                            item = victim.steal_batch(*locals[t], batch_size);
+                        }
+                        // other batch thieves are victims as well
+                        for(size_t v = 0; !item && v < thieves; ++v)
+                        {
+                            if(v != t)
+                            {
+                                ++myVisits;
+                                item = locals[v]->steal_batch(*locals[t], batch_size);
+                            }
+                        }
+                    }
+                    else
+                    {
+                        ++myVisits;
+                        item = victim.steal();
+                    }
+                    if(item)
+                    {
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                visits.fetch_add(myVisits, std::memory_order_relaxed);
+            });
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    start.store(true, std::memory_order_release);
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return {std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime), visits.load()};
+}
+
+// owner pushes a burst while a thief keeps stealing, then pops everything and goes back to a push/pop steady state
+void burst()
+{
+    Deque deque(64);
+    std::atomic<bool> done{false};
+    std::thread thief(
+        [&]
+        {
+            while(!done.load(std::memory_order_acquire))
+            {
+                deque.steal();
+            }
+        });
+
+    for(std::uintptr_t i = 0; i < item_count; ++i)
+    {
+        deque.emplace(i);
+    }
+    auto peak = deque.capacity();
+    while(deque.pop())
+    {
+    }
+    for(std::uintptr_t i = 0; i < 1000; ++i)
+    {
+        deque.emplace(i);
+        deque.pop();
+    }
+    done.store(true, std::memory_order_release);
+    thief.join();
+
+    std::printf("burst:\n");
+    std::printf("  - initial_capacity: %d\n", 64);
+    std::printf("    peak_capacity: %" PRId64 "\n", peak);
+    std::printf("    steady_capacity: %" PRId64 "\n", deque.capacity());
+}
+
+void report(char const* name, Result const& result)
+{
+    std::printf("  - mode: %s\n", name);
+    std::printf("    duration: %" PRIu64 " us\n", result.duration.count());
+    std::printf("    victim_visits: %" PRIu64 "\n", result.victim_visits);
+}
+
+int main()
+{
+    if(thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("items: %" PRIu64 "\n", item_count);
+    std::printf("runs:\n");
+    report("steal", drain<false>(thread_count));
+    report("steal_batch", drain<true>(thread_count));
+    burst();
+    return 0;
+}
@@ -0,0 +1,94 @@
+// 1D Gauss-Seidel style stencil over tiles. The task updating a tile writes it and reads both neighbours, so every
+// sweep readies tiles through their resources. With last writer routing a readied task prefers the worker that wrote
+// its tile last, the hit rate counts how often it ran there.
+
+#include <rg.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const tile_count = 64;
+static size_t const tile_size = 1 << 13;
+static size_t const sweep_count = 100;
+
+struct Tile
+{
+    std::vector<double> data = std::vector<double>(tile_size, 1.0);
+    // worker that last updated the tile
+    int32_t lastWorker = -1;
+};
+
+struct Hits
+{
+    std::atomic<uint64_t> same{0};
+    std::atomic<uint64_t> total{0};
+};
+
+auto update(Tile& tile, Tile const& left, Tile const& right, Hits* hits) -> rg::Task<void>
+{
+    auto const worker = rg::ThreadPool::current_worker();
+    if(tile.lastWorker >= 0)
+    {
+        hits->total.fetch_add(1, std::memory_order_relaxed);
+        if(tile.lastWorker == worker)
+        {
+            hits->same.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    tile.lastWorker = worker;
+
+    auto& x = tile.data;
+    x.front() = (left.data.back() + x.front() + x[1]) / 3.0;
+    for(size_t i = 1; i + 1 < x.size(); ++i)
+    {
+        x[i] = (x[i - 1] + x[i] + x[i + 1]) / 3.0;
+    }
+    x.back() = (x[x.size() - 2] + x.back() + right.data.front()) / 3.0;
+    co_return;
+}
+
+auto sweeps(std::vector<rg::Resource<Tile>>& tiles, Hits* hits) -> rg::Task<void>
+{
+    auto const n = tiles.size();
+    for(size_t s = 0; s < sweep_count; ++s)
+    {
+        for(size_t t = 0; t < n; ++t)
+        {
+            co_await rg::dispatch_task(
+                update,
+                tiles[t].rg_write(),
+                tiles[(t + n - 1) % n].rg_read(),
+                tiles[(t + 1) % n].rg_read(),
+                hits);
+        }
+    }
+    co_await rg::BarrierAwaiter{};
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    std::printf("runs:\n");
+    for(bool routing : {false, true})
+    {
+        rg::PoolOptions options;
+        options.lastWriterRouting = routing;
+        auto poolObj = rg::init(thread_count, options);
+
+        std::vector<rg::Resource<Tile>> tiles(tile_count);
+        Hits hits;
+        auto start = std::chrono::steady_clock::now();
+        rg::submit(poolObj.pool_ptr(), sweeps, std::ref(tiles), &hits).get();
+        auto duration
+            = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        auto const total = hits.total.load();
+        std::printf("  - last_writer_routing: %s\n", routing ? "true" : "false");
+        std::printf("    duration: %" PRIu64 " us\n", duration.count());
+        std::printf("    hit_rate: %.3f\n", total ? static_cast<double>(hits.same.load()) / total : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Threads outside the pool submit small task trees and block on their results, measuring the round trip from
+// submission to the result arriving back at the client thread. A task of the pool awaits a handle of a submission as
+// well.
+
+#include <rg.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const client_count = 4;
+static size_t const submit_count = 1'000;
+static size_t const fib_n = 12;
+
+using Clock = std::chrono::steady_clock;
+
+auto fib(size_t n) -> rg::Task<size_t>
+{
+    if(n < 2)
+    {
+        co_return n;
+    }
+    auto a = co_await rg::dispatch_task(fib, n - 1);
+    auto b = co_await rg::dispatch_task(fib, n - 2);
+    co_return co_await a.get() + co_await b.get();
+}
+
+// submits from inside the pool and awaits the handle without blocking the worker
+auto awaitSubmitted(rg::ThreadPool* pool, size_t* result) -> rg::Task<void>
+{
+    *result = co_await rg::submit(pool, fib, fib_n);
+    co_return;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+    auto const expected = rg::submit(pool, fib, fib_n).get();
+
+    std::vector<std::vector<Clock::duration>> latencies(client_count);
+    std::vector<size_t> errors(client_count, 0);
+    auto startTime = Clock::now();
+    {
+        std::vector<std::jthread> clients;
+        for(size_t c = 0; c < client_count; ++c)
+        {
+            clients.emplace_back(
+                [&, c]
+                {
+                    latencies[c].reserve(submit_count);
+                    for(size_t i = 0; i < submit_count; ++i)
+                    {
+                        auto start = Clock::now();
+                        auto result = rg::submit(pool, fib, fib_n).get();
+                        latencies[c].push_back(Clock::now() - start);
+                        errors[c] += result != expected;
+                    }
+                });
+        }
+    }
+    auto totalTime = Clock::now() - startTime;
+
+    size_t awaited = 0;
+    rg::submit(pool, awaitSubmitted, pool, &awaited).get();
+
+    std::vector<Clock::duration> all;
+    for(auto const& client : latencies)
+    {
+        all.insert(all.end(), client.begin(), client.end());
+    }
+    std::ranges::sort(all);
+    auto toUs = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    auto errorCount = std::accumulate(errors.begin(), errors.end(), size_t{0});
+    if(errorCount != 0 || awaited != expected)
+    {
+        std::printf("ERROR: wrong result\n");
+    }
+
+    std::printf("runs:\n");
+    std::printf("  - clients: %" PRIu64 "\n", client_count);
+    std::printf("    submit_count: %" PRIu64 "\n", client_count * submit_count);
+    std::printf("    duration: %" PRIu64 " us\n", toUs(totalTime));
+    std::printf("    latency_p50: %" PRIu64 " us\n", toUs(all[all.size() / 2]));
+    std::printf("    latency_p99: %" PRIu64 " us\n", toUs(all[all.size() * 99 / 100]));
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Every worker is kept busy by a long task made of many small chunks of work while a client thread submits short
+// probes in the high class. Without yielding a probe waits for a long task to finish. Yielding after every chunk, or
+// only when yield_if_needed sees waiting work, should bound the probe latency by the length of a chunk.
+
+#include <rg.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t const chunk_count = 2'000;
+static auto const chunk_work = std::chrono::microseconds(50);
+static size_t const probe_count = 50;
+static auto const probe_gap = std::chrono::microseconds(500);
+
+using Clock = std::chrono::steady_clock;
+
+enum class Mode
+{
+    Never,
+    IfNeeded,
+    Always,
+};
+
+auto longTask(Mode mode) -> rg::Task<void>
+{
+    for(size_t i = 0; i < chunk_count; ++i)
+    {
+        auto end = Clock::now() + chunk_work;
+        while(Clock::now() < end)
+        {
+        }
+        if(mode == Mode::Always)
+        {
+            co_await rg::yield();
+        }
+        else if(mode == Mode::IfNeeded)
+        {
+            co_await rg::yield_if_needed();
+        }
+    }
+    co_return;
+}
+
+auto probe() -> rg::Task<int>
+{
+    co_return 1;
+}
+
+int main()
+{
+    std::printf("threads: %" PRIu64 "\n", thread_count);
+    auto poolObj = rg::init(thread_count);
+    auto* pool = poolObj.pool_ptr();
+
+    auto toUs = [](Clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::printf("runs:\n");
+    for(auto [mode, name] : {std::pair{Mode::Never, "never"}, {Mode::IfNeeded, "if_needed"}, {Mode::Always, "always"}})
+    {
+        auto start = Clock::now();
+        std::vector<rg::SubmitHandle<void>> longTasks;
+        for(size_t w = 0; w < thread_count; ++w)
+        {
+            longTasks.push_back(rg::submit(pool, longTask, mode));
+        }
+        Clock::duration probeMax{};
+        for(size_t i = 0; i < probe_count; ++i)
+        {
+            std::this_thread::sleep_for(probe_gap);
+            auto probeStart = Clock::now();
+            rg::submit(pool, rg::TaskHints{rg::Priority::High}, probe).get();
+            probeMax = std::max(probeMax, Clock::now() - probeStart);
+        }
+        for(auto& handle : longTasks)
+        {
+            handle.wait();
+        }
+        std::printf("  - yield: %s\n", name);
+        std::printf("    duration: %" PRIu64 " us\n", toUs(Clock::now() - start));
+        std::printf("    probe_max: %" PRIu64 " us\n", toUs(probeMax));
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rg
+{
+    struct ResourceNode;
+
+    enum class AffinityKind : uint8_t
+    {
+        None,
+        Worker, // a worker index, taken modulo the pool size
+        NumaNode, // OS index of a NUMA node, spread over the workers placed on it
+        Resource, // the home worker of a resource, resolved in dispatch_task
+    };
+
+    // where a task should run. The handle goes to the inbox of the chosen worker, which runs its inbox before it
+    // steals. Only a hint: a full inbox, a retired worker or a node without workers fall back to the normal push
+    struct Affinity
+    {
+        AffinityKind kind = AffinityKind::None;
+        uint32_t target = 0;
+        ResourceNode* resource = nullptr;
+
+        static Affinity worker(uint32_t index) noexcept
+        {
+            return {AffinityKind::Worker, index};
+        }
+
+        static Affinity numaNode(uint32_t node) noexcept
+        {
+            return {AffinityKind::NumaNode, node};
+        }
+
+        // run where the tasks of the resource run. The first task dispatched with it makes the dispatching worker
+        // the home of the resource, unless ResourceNode::set_home_worker picked one before
+        template<typename TResource>
+        static Affinity sameAs(TResource const& resource) noexcept
+        {
+            return {AffinityKind::Resource, 0, resource.getUserQueue().get()};
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return kind != AffinityKind::None;
+        }
+    };
+} // namespace rg
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "PoolOptions.hpp"
+#include "ThreadPool.hpp"
+#include "submit.hpp"
+
+#include <concepts>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace rg
+{
+    // named, isolated pools of one process, e.g. a latency tier next to a batch tier. Every arena has its own
+    // workers, queues and placement. Give the arenas disjoint explicit cpusets to keep them off each other's cores.
+    // Idle workers of one arena can be lent to another, bounded by the borrow quota of the borrowing arena
+    struct Arenas
+    {
+        Arenas() = default;
+        Arenas(Arenas const&) = delete;
+        Arenas& operator=(Arenas const&) = delete;
+
+        // workers of different arenas may hold pointers to each other's pools, stop all of them before destroying any
+        ~Arenas()
+        {
+            for(auto& [name, pool] : arenas)
+            {
+                pool->shutdown();
+            }
+        }
+
+        ThreadPool& create(std::string name, std::unsigned_integral auto size, PoolOptions const& options = {})
+        {
+            std::lock_guard lock(mtx);
+            if(arenas.contains(name))
+            {
+                throw std::invalid_argument("Arena " + name + " exists already.");
+            }
+            auto& pool = arenas[std::move(name)];
+            pool = std::make_unique<ThreadPool>(size, options);
+            return *pool;
+        }
+
+        ThreadPool& get(std::string_view name) const
+        {
+            if(auto* pool = find(name))
+            {
+                return *pool;
+            }
+            throw std::out_of_range("No arena named " + std::string(name) + ".");
+        }
+
+        ThreadPool* find(std::string_view name) const
+        {
+            std::lock_guard lock(mtx);
+            auto it = arenas.find(name);
+            return it == arenas.end() ? nullptr : it->second.get();
+        }
+
+        // idle workers of lender run tasks of borrower, at most borrower's quota of them at once
+        void lend(std::string_view lender, std::string_view borrower, uint32_t quota)
+        {
+            auto& borrowing = get(borrower);
+            get(lender).lend_to(borrowing);
+            borrowing.set_borrow_quota(quota);
+        }
+
+        template<typename Callable, typename... Args>
+        requires(!std::is_same_v<std::decay_t<Callable>, TaskHints>)
+        auto submit(std::string_view name, Callable&& callable, Args&&... args)
+        {
+            return rg::submit(&get(name), std::forward<Callable>(callable), std::forward<Args>(args)...);
+        }
+
+        template<typename Callable, typename... Args>
+        auto submit(std::string_view name, TaskHints hints, Callable&& callable, Args&&... args)
+        {
+            return rg::submit(&get(name), hints, std::forward<Callable>(callable), std::forward<Args>(args)...);
+        }
+
+    private:
+        mutable std::mutex mtx;
+        std::map<std::string, std::unique_ptr<ThreadPool>, std::less<>> arenas;
+    };
+} // namespace rg
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "waitCounter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#    include <ctime>
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace rg
+{
+    // Eventcount used to park idle workers. Inspired by Dmitry Vyukov's eventcount and folly::EventCount.
+    // A waiter announces itself with prepare_wait, rechecks its wake condition and then either calls cancel_wait or
+    // commit_wait. A notifier publishes its work first and then calls notify, which costs a fence and a load when no
+    // one is parked.
+    class EventCount
+    {
+    public:
+        using Key = uint32_t;
+
+        EventCount() = default;
+        EventCount(EventCount const&) = delete;
+        EventCount(EventCount&&) = delete;
+        EventCount& operator=(EventCount const&) = delete;
+        EventCount& operator=(EventCount&&) = delete;
+
+        // Register as waiter. The returned key must be passed to commit_wait
+        Key prepare_wait() noexcept
+        {
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            // pairs with the fence in notify, either the waiter sees the published work or the notifier sees the
+            // waiter
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return epoch.load(std::memory_order_acquire);
+        }
+
+        // Deregister after the recheck found work
+        void cancel_wait() noexcept
+        {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Sleep until a notify happened after prepare_wait
+        void commit_wait(Key key) noexcept
+        {
+            while(epoch.load(std::memory_order_acquire) == key)
+            {
+                futex_wait(key);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Like commit_wait, but gives up after timeout. Returns whether a notify ended the wait
+        bool commit_wait_for(Key key, std::chrono::nanoseconds timeout) noexcept
+        {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            bool notified = true;
+            while(epoch.load(std::memory_order_acquire) == key)
+            {
+                auto const left = deadline - std::chrono::steady_clock::now();
+                if(left <= std::chrono::nanoseconds::zero())
+                {
+                    notified = false;
+                    break;
+                }
+                futex_wait_for(key, std::chrono::duration_cast<std::chrono::nanoseconds>(left));
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return notified;
+        }
+
+        // Wake up to n parked waiters
+        void notify(uint32_t n) noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(n == 0 || waiters.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+            epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(n);
+        }
+
+        void notify_one() noexcept
+        {
+            notify(1);
+        }
+
+        void notify_all() noexcept
+        {
+            notify(INT_MAX);
+        }
+
+        // Number of threads between prepare_wait and the end of their wait. Only a hint
+        uint32_t num_waiters() const noexcept
+        {
+            return waiters.load(std::memory_order_relaxed);
+        }
+
+    private:
+        alignas(hardware_destructive_interference_size) std::atomic<uint32_t> epoch{0};
+        alignas(hardware_destructive_interference_size) std::atomic<uint32_t> waiters{0};
+
+#if defined(__linux__)
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32 bit word");
+
+        void futex_wait(Key key) noexcept
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+        }
+
+        void futex_wait_for(Key key, std::chrono::nanoseconds timeout) noexcept
+        {
+            auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(seconds.count());
+            ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+        }
+
+        void futex_wake(uint32_t n) noexcept
+        {
+            syscall(
+                SYS_futex,
+                reinterpret_cast<uint32_t*>(&epoch),
+                FUTEX_WAKE_PRIVATE,
+                n > INT_MAX ? INT_MAX : n,
+                nullptr,
+                nullptr,
+                0);
+        }
+#else
+        void futex_wait(Key key) noexcept
+        {
+            epoch.wait(key, std::memory_order_acquire);
+        }
+
+        // atomic wait has no timeout, poll in short naps instead
+        void futex_wait_for(Key, std::chrono::nanoseconds timeout) noexcept
+        {
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(50)));
+        }
+
+        void futex_wake(uint32_t n) noexcept
+        {
+            if(n == 1)
+            {
+                epoch.notify_one();
+            }
+            else
+            {
+                epoch.notify_all();
+            }
+        }
+#endif
+    };
+} // namespace rg
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <hwloc.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rg
+{
+    // How the workers of a pool are bound to the machine
+    enum class PlacementKind : uint8_t
+    {
+        Compact, // worker i on core i, one hardware thread per core
+        Scatter, // consecutive workers on different packages, one hardware thread per core
+        PerPU, // worker i on hardware thread i, SMT siblings are filled before moving on to the next core
+        Unpinned, // no binding, the OS schedules the workers
+        Explicit, // user given cpusets
+    };
+
+    struct Placement
+    {
+        PlacementKind kind = PlacementKind::Compact;
+        // allow more workers than places, places are then reused round robin
+        bool oversubscribe = false;
+        // Explicit only: OS indices of the hardware threads worker i may run on, reused round robin
+        std::vector<std::vector<unsigned>> cpusets{};
+
+        static Placement compact(bool oversubscribe = false)
+        {
+            return {PlacementKind::Compact, oversubscribe};
+        }
+
+        static Placement scatter(bool oversubscribe = false)
+        {
+            return {PlacementKind::Scatter, oversubscribe};
+        }
+
+        static Placement perPU(bool oversubscribe = false)
+        {
+            return {PlacementKind::PerPU, oversubscribe};
+        }
+
+        static Placement unpinned()
+        {
+            return {PlacementKind::Unpinned, true};
+        }
+
+        static Placement explicitCpusets(std::vector<std::vector<unsigned>> sets, bool oversubscribe = false)
+        {
+            return {PlacementKind::Explicit, oversubscribe, std::move(sets)};
+        }
+    };
+
+    // owning wrapper around a hwloc bitmap, empty for unpinned workers
+    struct CpuSet
+    {
+        struct Deleter
+        {
+            void operator()(hwloc_bitmap_s* set) const noexcept
+            {
+                hwloc_bitmap_free(set);
+            }
+        };
+
+        std::unique_ptr<hwloc_bitmap_s, Deleter> set;
+
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(set);
+        }
+
+        hwloc_const_cpuset_t get() const noexcept
+        {
+            return set.get();
+        }
+    };
+
+    namespace detail
+    {
+        inline CpuSet singlePU(hwloc_obj_t obj)
+        {
+            CpuSet cpuset{std::unique_ptr<hwloc_bitmap_s, CpuSet::Deleter>(hwloc_bitmap_dup(obj->cpuset))};
+            // Restrict to a single hardware thread
+            hwloc_bitmap_singlify(cpuset.set.get());
+            return cpuset;
+        }
+
+        // cores ordered so that neighbours in the list sit on different packages
+        inline std::vector<hwloc_obj_t> scatteredCores(hwloc_topology_t topology)
+        {
+            int numPackages = std::max(hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_PACKAGE), 1);
+            std::vector<std::vector<hwloc_obj_t>> perPackage(static_cast<std::size_t>(numPackages));
+            int numCores = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_CORE);
+            for(int c = 0; c < numCores; ++c)
+            {
+                hwloc_obj_t core = hwloc_get_obj_by_type(topology, HWLOC_OBJ_CORE, c);
+                hwloc_obj_t package = hwloc_get_ancestor_obj_by_type(topology, HWLOC_OBJ_PACKAGE, core);
+                perPackage[package ? package->logical_index : 0].push_back(core);
+            }
+
+            std::vector<hwloc_obj_t> cores;
+            cores.reserve(static_cast<std::size_t>(numCores));
+            for(std::size_t round = 0; cores.size() < static_cast<std::size_t>(numCores); ++round)
+            {
+                for(auto const& package : perPackage)
+                {
+                    if(round < package.size())
+                    {
+                        cores.push_back(package[round]);
+                    }
+                }
+            }
+            return cores;
+        }
+
+        // explicit cpusets are checked here, a bad one would only fail in pinThread on the worker, where the throw
+        // terminates. Throws if a set is empty or names a hardware thread the process may not run on
+        inline void checkExplicitCpusets(hwloc_topology_t topology, std::vector<std::vector<unsigned>> const& cpusets)
+        {
+            hwloc_const_cpuset_t allowed = hwloc_topology_get_allowed_cpuset(topology);
+            for(auto const& osIndices : cpusets)
+            {
+                if(osIndices.empty())
+                {
+                    throw std::runtime_error("Empty cpuset in explicit placement.");
+                }
+                for(unsigned osIndex : osIndices)
+                {
+                    if(!hwloc_bitmap_isset(allowed, osIndex))
+                    {
+                        throw std::runtime_error("Explicit placement names a processing unit that is not allowed.");
+                    }
+                }
+            }
+        }
+    } // namespace detail
+
+    // One cpuset per worker. Throws if the placement has fewer places than workers and does not oversubscribe, or if
+    // an explicit cpuset is empty or not allowed
+    inline std::vector<CpuSet> computePlaces(hwloc_topology_t topology, std::size_t size, Placement const& placement)
+    {
+        std::vector<hwloc_obj_t> objs;
+        switch(placement.kind)
+        {
+        case PlacementKind::Compact:
+            for(int c = 0; c < hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_CORE); ++c)
+            {
+                objs.push_back(hwloc_get_obj_by_type(topology, HWLOC_OBJ_CORE, c));
+            }
+            break;
+        case PlacementKind::Scatter:
+            objs = detail::scatteredCores(topology);
+            break;
+        case PlacementKind::PerPU:
+            for(int p = 0; p < hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_PU); ++p)
+            {
+                objs.push_back(hwloc_get_obj_by_type(topology, HWLOC_OBJ_PU, p));
+            }
+            break;
+        case PlacementKind::Unpinned:
+            return std::vector<CpuSet>(size);
+        case PlacementKind::Explicit:
+            detail::checkExplicitCpusets(topology, placement.cpusets);
+            break;
+        }
+
+        std::size_t numPlaces = placement.kind == PlacementKind::Explicit ? placement.cpusets.size() : objs.size();
+        if(numPlaces == 0 || (numPlaces < size && !placement.oversubscribe))
+        {
+            throw std::runtime_error(
+                placement.kind == PlacementKind::PerPU || placement.kind == PlacementKind::Explicit
+                    ? "Insufficient processing units for thread pool size."
+                    : "Insufficient cores for thread pool size.");
+        }
+
+        std::vector<CpuSet> places;
+        places.reserve(size);
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            if(placement.kind == PlacementKind::Explicit)
+            {
+                CpuSet cpuset{std::unique_ptr<hwloc_bitmap_s, CpuSet::Deleter>(hwloc_bitmap_alloc())};
+                for(unsigned osIndex : placement.cpusets[i % numPlaces])
+                {
+                    hwloc_bitmap_set(cpuset.set.get(), osIndex);
+                }
+                places.push_back(std::move(cpuset));
+            }
+            else
+            {
+                places.push_back(detail::singlePU(objs[i % numPlaces]));
+            }
+        }
+        return places;
+    }
+
+    // hwloc object used to measure distances between workers, the root for unpinned workers
+    inline hwloc_obj_t placeObject(hwloc_topology_t topology, CpuSet const& place)
+    {
+        if(!place)
+        {
+            return hwloc_get_root_obj(topology);
+        }
+        hwloc_obj_t obj = hwloc_get_obj_covering_cpuset(topology, place.get());
+        return obj ? obj : hwloc_get_root_obj(topology);
+    }
+
+    // OS index of the NUMA node local to a place object, -1 for the root, i.e. unpinned workers
+    inline int numaNodeOf(hwloc_topology_t topology, hwloc_obj_t obj)
+    {
+        if(obj == hwloc_get_root_obj(topology) || !obj->nodeset)
+        {
+            return -1;
+        }
+        return hwloc_bitmap_first(obj->nodeset);
+    }
+} // namespace rg
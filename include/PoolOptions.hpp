@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Placement.hpp"
+#include "SchedulerTrace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace rg
+{
+    // if size is known at compile time, get it from init as template param and use it for faster containers
+    constexpr uint32_t threadPoolStackSize = 64u;
+
+    struct PoolOptions
+    {
+        Placement placement{};
+        // initial capacity of every deque of the pool, rounded up to a power of 2. The deques grow in bursts and
+        // shrink back to it, so a capacity that covers the steady state keeps emplace free of allocations
+        int64_t queueCapacity = threadPoolStackSize;
+        // slots of the queue threads outside the pool submit into. Submitters block while it is full
+        std::size_t injectionCapacity = 1024u;
+        // slots of the per worker inboxes that tasks with an affinity hint are routed to
+        std::size_t inboxCapacity = 256u;
+        // granularity of rg::sleep_for and rg::sleep_until. Sleeps end on the first tick at or after their deadline
+        std::chrono::nanoseconds timerTick = std::chrono::microseconds(50);
+        // tasks readied by a resource prefer the worker that last wrote it, see ThreadPool::addReadyTask
+        bool lastWriterRouting = true;
+        // most idle workers of other pools that may run tasks of this one at once, see ThreadPool::lend_to
+        uint32_t borrowQuota = 0;
+        // elastic pools retire idle workers down to minWorkers and bring them back, up to the size of the pool, when
+        // work piles up. 0 keeps all workers active unless ThreadPool::set_worker_count says otherwise
+        std::size_t minWorkers = 0;
+        // parks in a row without work after which the highest active worker of an elastic pool retires
+        uint32_t retireAfterParks = 4;
+        // base of the per worker seeds for victim selection. 0 draws them from std::random_device
+        uint32_t seed = 0;
+        // keep the seeds and every steal of the workers, see ThreadPool::trace
+        bool recordTrace = false;
+        // start from the seeds of a recorded trace and follow its steals. Needs as many workers as the trace
+        std::shared_ptr<SchedulerTrace const> replayTrace{};
+
+        int64_t roundedQueueCapacity() const noexcept
+        {
+            return static_cast<int64_t>(std::bit_ceil(static_cast<uint64_t>(std::max<int64_t>(queueCapacity, 1))));
+        }
+    };
+} // namespace rg
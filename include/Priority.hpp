@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rg
+{
+    // scheduling class of a task, workers drain higher classes first
+    enum class Priority : uint8_t
+    {
+        High, // latency critical
+        Normal,
+        Background, // batch work, only runs when nothing else is ready or when it has aged
+    };
+
+    inline constexpr std::size_t numPriorities = 3;
+} // namespace rg
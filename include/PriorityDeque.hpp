@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Priority.hpp"
+#include "dequeue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace rg
+{
+    // one work stealing deque per priority class. Same ownership rules as riften::Deque: only the owner pushes and
+    // pops, anyone steals
+    class PriorityDeque
+    {
+    public:
+        using value_type = std::coroutine_handle<>;
+        using deque_type = riften::Deque<value_type>;
+
+        explicit PriorityDeque(std::int64_t cap)
+        {
+            for(auto& deque : deques)
+            {
+                deque = std::make_unique<deque_type>(cap);
+            }
+        }
+
+        deque_type& operator[](Priority priority) noexcept
+        {
+            return *deques[static_cast<std::size_t>(priority)];
+        }
+
+        deque_type const& operator[](Priority priority) const noexcept
+        {
+            return *deques[static_cast<std::size_t>(priority)];
+        }
+
+        void emplace(value_type h, Priority priority)
+        {
+            (*this)[priority].emplace(h);
+        }
+
+        // highest class first. An aged pop starts at the lowest class, so background work cannot starve
+        std::optional<value_type> pop(bool aged) noexcept
+        {
+            for(std::size_t p = 0; p < numPriorities; ++p)
+            {
+                auto priority = static_cast<Priority>(aged ? numPriorities - 1 - p : p);
+                if(auto h = (*this)[priority].pop())
+                {
+                    return h;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // steal from one class, the rest of the batch lands in the same class of dest
+        std::optional<value_type> steal_batch(PriorityDeque& dest, std::int64_t max, Priority priority)
+        {
+            return (*this)[priority].steal_batch(dest[priority], max);
+        }
+
+        std::size_t size() const noexcept
+        {
+            std::size_t total = 0;
+            for(auto const& deque : deques)
+            {
+                total += deque->size();
+            }
+            return total;
+        }
+
+        bool empty() const noexcept
+        {
+            for(auto const& deque : deques)
+            {
+                if(!deque->empty())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // largest high-water mark of the classes
+        std::size_t high_water_mark() const noexcept
+        {
+            std::size_t mark = 0;
+            for(auto const& deque : deques)
+            {
+                mark = std::max(mark, deque->high_water_mark());
+            }
+            return mark;
+        }
+
+        void reset_high_water_mark() noexcept
+        {
+            for(auto& deque : deques)
+            {
+                deque->reset_high_water_mark();
+            }
+        }
+
+    private:
+        std::array<std::unique_ptr<deque_type>, numPriorities> deques;
+    };
+} // namespace rg
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// The compact promise layout is compiled in with -DRG_COMPACT_PROMISE (cmake -DRG_COMPACT_PROMISE=ON). By default
+// every atomic of a task promise gets a cache line of its own. The compact layout packs them together at the head of
+// the frame, keeps the resource list of a task out of line and does not store the pool of a task, which keeps small
+// frames in the slab of CoroAllocator.
+
+namespace rg
+{
+#ifdef RG_COMPACT_PROMISE
+    inline constexpr bool compactPromise = true;
+#else
+    inline constexpr bool compactPromise = false;
+#endif
+
+    // alignment of each atomic of a task promise
+    inline constexpr std::size_t promiseAtomicAlign
+        = compactPromise ? alignof(std::atomic<uint32_t>) : hardware_destructive_interference_size;
+
+    // pool of a task, set in await_transform of the parent
+    template<bool stored = !compactPromise>
+    struct TaskPool
+    {
+        ThreadPool* pool_p{};
+
+        ThreadPool* pool() const noexcept
+        {
+            return pool_p;
+        }
+
+        void set_pool(ThreadPool* pool) noexcept
+        {
+            pool_p = pool;
+        }
+    };
+
+    // a task is only resumed by threads that run tasks of its pool, so the pool the calling thread runs is the pool
+    // of the task
+    template<>
+    struct TaskPool<false>
+    {
+        static ThreadPool* pool() noexcept
+        {
+            return ThreadPool::running_pool();
+        }
+
+        void set_pool(ThreadPool*) noexcept
+        {
+        }
+    };
+} // namespace rg
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "Affinity.hpp"
+#include "Priority.hpp"
 #include "ThreadPool.hpp"
 #include "resources.hpp"
 #include "waitCounter.hpp"
@@ -9,6 +11,9 @@
 #include <atomic>
 #include <coroutine>
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
 
 namespace rg
 {
@@ -18,19 +23,37 @@ namespace rg
         std::coroutine_handle<> handle; // Coroutine handle
         std::atomic<TWaitCount>* waitCounter_p{};
         AccessMode accessMode;
+        // class the task is pushed to once it is ready
+        Priority priority = Priority::Normal;
         // remove state 0 - default
         // remove state 1 - removed
         bool remove_state = 0;
+        // resolved affinity of the task, kept as kind and target to fit the padding of the entry
+        AffinityKind affinityKind = AffinityKind::None;
+        uint32_t affinityTarget = 0;
 
         // TODO try passing T as parameter and then constructing
         template<typename TAccess>
-        task_access(std::coroutine_handle<> coro_handle, TAccess&& mode, std::atomic<uint32_t>* waitCtr_p)
+        task_access(
+            std::coroutine_handle<> coro_handle,
+            TAccess&& mode,
+            std::atomic<uint32_t>* waitCtr_p,
+            Priority prio = Priority::Normal,
+            Affinity const& affinity = {})
             : handle(coro_handle)
             , waitCounter_p{waitCtr_p}
             , accessMode(std::forward<TAccess>(mode))
+            , priority{prio}
+            , affinityKind{affinity.kind}
+            , affinityTarget{affinity.target}
         {
         }
 
+        Affinity affinity() const noexcept
+        {
+            return {affinityKind, affinityTarget};
+        }
+
         // TODO think about default access mode and waitPtr
         task_access() : handle(nullptr)
         {
@@ -43,6 +66,8 @@ namespace rg
         ~task_access() = default;
     };
 
+    static_assert(sizeof(task_access) == 24, "the affinity has to fit into the padding of task_access");
+
     // ResourceNode struct with firstNotReady and notify function
     struct ResourceNode
     {
@@ -53,6 +78,10 @@ namespace rg
         alignas(hardware_destructive_interference_size) std::atomic<uint32_t> last
             = 0; // Iterator to one past the last task
         uint32_t resource_uid; // Unique identifier for the resource
+        // worker the tasks with Affinity::sameAs this resource are routed to, -1 until one is chosen
+        std::atomic<int32_t> home_worker{-1};
+        // worker of the pool the resource is used in that last finished a task writing it, -1 if none yet
+        std::atomic<int32_t> last_writer{-1};
         std::array<task_access, 1024> tasks;
 
     public:
@@ -67,6 +96,40 @@ namespace rg
             return resource_uid;
         }
 
+        int32_t get_home_worker() const noexcept
+        {
+            return home_worker.load(std::memory_order_relaxed);
+        }
+
+        void set_home_worker(int32_t worker) noexcept
+        {
+            home_worker.store(worker, std::memory_order_relaxed);
+        }
+
+        int32_t get_last_writer() const noexcept
+        {
+            return last_writer.load(std::memory_order_relaxed);
+        }
+
+        void set_last_writer(int32_t worker) noexcept
+        {
+            if(worker >= 0)
+            {
+                last_writer.store(worker, std::memory_order_relaxed);
+            }
+        }
+
+        // the first worker to ask becomes the home, returns the home or -1 if there is none yet
+        int32_t claim_home_worker(int32_t worker) noexcept
+        {
+            int32_t expected = -1;
+            if(worker < 0 || home_worker.compare_exchange_strong(expected, worker, std::memory_order_relaxed))
+            {
+                return worker < 0 ? expected : worker;
+            }
+            return expected;
+        }
+
         // Add a task to the list, incremenets wait counter of task if task is not immidiately ready to run
         // TODO think about rvalue reference
         // TODO think about returning somethin useful. Maybe bool telling if it is ready
@@ -230,7 +293,12 @@ namespace rg
                     if(tasks[fnr].waitCounter_p->fetch_sub(1, std::memory_order_acq_rel) == 1)
                     {
                         // move handle to ready tasks queue
-                        pool_p->addTask(tasks[fnr].handle);
+                        ThreadPool::recordStat(&WorkerCounters::tasks_readied);
+                        pool_p->addReadyTask(
+                            tasks[fnr].handle,
+                            tasks[fnr].priority,
+                            tasks[fnr].affinity(),
+                            get_last_writer());
                     }
                     ++fnr;
                 }
@@ -259,7 +327,12 @@ namespace rg
                         if(tasks[fnr].waitCounter_p->fetch_sub(1, std::memory_order_acq_rel) == 1)
                         {
                             // move handle to ready tasks queue
-                            pool_p->addTask(tasks[fnr].handle);
+                            ThreadPool::recordStat(&WorkerCounters::tasks_readied);
+                            pool_p->addReadyTask(
+                                tasks[fnr].handle,
+                                tasks[fnr].priority,
+                                tasks[fnr].affinity(),
+                                get_last_writer());
                         }
                         ++fnr;
                     }
@@ -278,4 +351,42 @@ namespace rg
             return;
         }
     };
+
+    // replaces a resource affinity by the worker it stands for. Called in dispatch_task, on the dispatching worker
+    inline Affinity resolveAffinity(Affinity const& affinity) noexcept
+    {
+        if(affinity.kind != AffinityKind::Resource)
+        {
+            return affinity;
+        }
+        auto home = affinity.resource->claim_home_worker(ThreadPool::current_worker());
+        return home < 0 ? Affinity{} : Affinity::worker(static_cast<uint32_t>(home));
+    }
+
+    // bit i of writeMask is set if node i was accessed with a mode other than read. Every node from bit 63 on shares
+    // the last bit
+    inline uint64_t writeBit(std::size_t nodeIndex) noexcept
+    {
+        return uint64_t{1} << (nodeIndex < 63 ? nodeIndex : 63);
+    }
+
+    // called from final_suspend: the written resources now live in the cache of the calling worker
+    inline void recordLastWriter(
+        std::span<std::shared_ptr<ResourceNode> const> nodes,
+        uint64_t writeMask,
+        ThreadPool const* pool_p) noexcept
+    {
+        if(writeMask == 0)
+        {
+            return;
+        }
+        auto const worker = pool_p->calling_worker();
+        for(std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if(writeMask & writeBit(i))
+            {
+                nodes[i]->set_last_writer(worker);
+            }
+        }
+    }
 } // namespace rg
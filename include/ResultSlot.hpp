@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoroAllocator.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace rg
+{
+    // result of a SlotTask, kept apart from the coroutine frame. The promise and the Task each hold one of the two
+    // references, so the frame can go away at final_suspend while the result waits for get. Comes from the frame
+    // allocator, so a small result takes a small block
+    template<typename T>
+    struct ResultSlot
+    {
+        static constexpr uint32_t pending = 0;
+        // a coroutine is suspended in get
+        static constexpr uint32_t awaited = 1;
+        static constexpr uint32_t done = 2;
+
+        std::atomic<uint32_t> state{pending};
+        std::atomic<uint32_t> owners{2};
+        // coroutine suspended in get, resumed by the final_suspend of the task
+        std::coroutine_handle<> awaiter{};
+        std::optional<T> result;
+
+        // called once by the task after the result is stored. Returns the coroutine to resume, if one waits
+        std::coroutine_handle<> complete() noexcept
+        {
+            if(state.exchange(done, std::memory_order_acq_rel) == awaited)
+            {
+                return awaiter;
+            }
+            return nullptr;
+        }
+
+        void release() noexcept
+        {
+            if(owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete this;
+            }
+        }
+
+        static void* operator new(std::size_t n) noexcept
+        {
+            return CoroAllocator::allocate(n).ptr;
+        }
+
+        static void operator delete(void* ptr, std::size_t n) noexcept
+        {
+            CoroAllocator::deallocate({ptr, n});
+        }
+    };
+
+    template<typename T>
+    struct ReleaseResultSlot
+    {
+        void operator()(ResultSlot<T>* slot) const noexcept
+        {
+            slot->release();
+        }
+    };
+
+    // one of the two references to a slot
+    template<typename T>
+    using ResultSlotRef = std::unique_ptr<ResultSlot<T>, ReleaseResultSlot<T>>;
+
+    // get of a SlotTask. Like GetAwaiter, but only touches the slot
+    template<typename T>
+    struct SlotGetAwaiter
+    {
+        ResultSlotRef<T> slot;
+
+        bool await_ready() const noexcept
+        {
+            return slot->state.load(std::memory_order_acquire) == ResultSlot<T>::done;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) const noexcept
+        {
+            slot->awaiter = h;
+            uint32_t expectedState = ResultSlot<T>::pending;
+            slot->state.compare_exchange_strong(expectedState, ResultSlot<T>::awaited, std::memory_order_acq_rel);
+            // the task finished in between, carry on
+            return expectedState != ResultSlot<T>::done;
+        }
+
+        T await_resume() noexcept
+        {
+            return std::move(*slot->result);
+        }
+    };
+} // namespace rg
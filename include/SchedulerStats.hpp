@@ -0,0 +1,226 @@
+#pragma once
+
+#include "VictimOrder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Scheduler counters are compiled in with -DRG_ENABLE_STATS (cmake -DRG_ENABLE_STATS=ON). Without it the counters of
+// a worker are an empty type and every update is a no-op, so the calls can stay in the hot paths.
+
+namespace rg
+{
+#ifdef RG_ENABLE_STATS
+    inline constexpr bool statsEnabled = true;
+#else
+    inline constexpr bool statsEnabled = false;
+#endif
+
+    // counter written by a single thread and read by anyone, so updates need no read-modify-write
+    template<bool Enabled = statsEnabled>
+    struct StatCounter
+    {
+        std::atomic<uint64_t> value{0};
+
+        void add(uint64_t n = 1) noexcept
+        {
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        uint64_t load() const noexcept
+        {
+            return value.load(std::memory_order_relaxed);
+        }
+
+        void reset() noexcept
+        {
+            value.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    template<>
+    struct StatCounter<false>
+    {
+        void add(uint64_t = 1) noexcept
+        {
+        }
+
+        uint64_t load() const noexcept
+        {
+            return 0;
+        }
+
+        void reset() noexcept
+        {
+        }
+    };
+
+    // live counters of one worker
+    template<bool Enabled = statsEnabled>
+    struct BasicWorkerCounters
+    {
+        // names one of the counters below, see add
+        using Counter = StatCounter<true> BasicWorkerCounters::*;
+
+        // handles resumed from the own deque or from a steal
+        StatCounter<true> tasks_resumed;
+        // handles pushed with addTask, including continuations and tasks readied by resources
+        StatCounter<true> tasks_pushed;
+        // tasks whose last resource dependency was released by this thread
+        StatCounter<true> tasks_readied;
+        // handles taken from the injection queue, pushed by threads outside the pool
+        StatCounter<true> tasks_injected;
+        // tasks of other pools run while this worker was lent to them
+        StatCounter<true> tasks_borrowed;
+        // handles that gave their worker back with rg::yield
+        StatCounter<true> tasks_yielded;
+        // children run inline by their dispatching task, see ThreadPool::inlineChild
+        StatCounter<true> tasks_inlined;
+        // victims visited
+        StatCounter<true> steal_attempts;
+        StatCounter<true> steals;
+        // items taken by successful steals, the rest of a batch lands in the own deque
+        StatCounter<true> stolen_items;
+        // time spent in steal, successful or not
+        StatCounter<true> steal_time_ns;
+        // times the worker parked on the event count
+        StatCounter<true> parks;
+
+        void add(Counter counter, uint64_t n = 1) noexcept
+        {
+            (this->*counter).add(n);
+        }
+
+        void reset() noexcept
+        {
+            tasks_resumed.reset();
+            tasks_pushed.reset();
+            tasks_readied.reset();
+            tasks_injected.reset();
+            tasks_borrowed.reset();
+            tasks_yielded.reset();
+            tasks_inlined.reset();
+            steal_attempts.reset();
+            steals.reset();
+            stolen_items.reset();
+            steal_time_ns.reset();
+            parks.reset();
+        }
+    };
+
+    // without stats the struct is empty. The counters are static so that &WorkerCounters::name still compiles
+    template<>
+    struct BasicWorkerCounters<false>
+    {
+        using Counter = StatCounter<false> const*;
+
+        static constexpr StatCounter<false> tasks_resumed{};
+        static constexpr StatCounter<false> tasks_pushed{};
+        static constexpr StatCounter<false> tasks_readied{};
+        static constexpr StatCounter<false> tasks_injected{};
+        static constexpr StatCounter<false> tasks_borrowed{};
+        static constexpr StatCounter<false> tasks_yielded{};
+        static constexpr StatCounter<false> tasks_inlined{};
+        static constexpr StatCounter<false> steal_attempts{};
+        static constexpr StatCounter<false> steals{};
+        static constexpr StatCounter<false> stolen_items{};
+        static constexpr StatCounter<false> steal_time_ns{};
+        static constexpr StatCounter<false> parks{};
+
+        void add(Counter, uint64_t = 1) noexcept
+        {
+        }
+
+        void reset() noexcept
+        {
+        }
+    };
+
+    static_assert(std::is_empty_v<BasicWorkerCounters<false>>);
+
+    using WorkerCounters = BasicWorkerCounters<>;
+
+    // snapshot of the counters of one worker
+    struct WorkerStats
+    {
+        uint64_t tasks_resumed = 0;
+        uint64_t tasks_pushed = 0;
+        uint64_t tasks_readied = 0;
+        uint64_t tasks_injected = 0;
+        uint64_t tasks_borrowed = 0;
+        uint64_t tasks_yielded = 0;
+        uint64_t tasks_inlined = 0;
+        uint64_t steal_attempts = 0;
+        uint64_t steals = 0;
+        uint64_t stolen_items = 0;
+        std::chrono::nanoseconds steal_time{};
+        uint64_t parks = 0;
+        // most handles the deque held at once
+        uint64_t deque_high_water = 0;
+        // successful steals by victim locality, counted in every build
+        std::array<uint64_t, numStealLocalities> steal_locality{};
+
+        WorkerStats() = default;
+
+        WorkerStats(WorkerCounters const& counters, uint64_t highWater)
+            : tasks_resumed{counters.tasks_resumed.load()}
+            , tasks_pushed{counters.tasks_pushed.load()}
+            , tasks_readied{counters.tasks_readied.load()}
+            , tasks_injected{counters.tasks_injected.load()}
+            , tasks_borrowed{counters.tasks_borrowed.load()}
+            , tasks_yielded{counters.tasks_yielded.load()}
+            , tasks_inlined{counters.tasks_inlined.load()}
+            , steal_attempts{counters.steal_attempts.load()}
+            , steals{counters.steals.load()}
+            , stolen_items{counters.stolen_items.load()}
+            , steal_time{counters.steal_time_ns.load()}
+            , parks{counters.parks.load()}
+            , deque_high_water{highWater}
+        {
+        }
+
+        WorkerStats& operator+=(WorkerStats const& other) noexcept
+        {
+            tasks_resumed += other.tasks_resumed;
+            tasks_pushed += other.tasks_pushed;
+            tasks_readied += other.tasks_readied;
+            tasks_injected += other.tasks_injected;
+            tasks_borrowed += other.tasks_borrowed;
+            tasks_yielded += other.tasks_yielded;
+            tasks_inlined += other.tasks_inlined;
+            steal_attempts += other.steal_attempts;
+            steals += other.steals;
+            stolen_items += other.stolen_items;
+            steal_time += other.steal_time;
+            parks += other.parks;
+            deque_high_water = std::max(deque_high_water, other.deque_high_water);
+            for(std::size_t l = 0; l < numStealLocalities; ++l)
+            {
+                steal_locality[l] += other.steal_locality[l];
+            }
+            return *this;
+        }
+    };
+
+    // snapshot of a pool. Counters are read one by one while the workers run, so the values are not a consistent cut
+    struct PoolStats
+    {
+        std::vector<WorkerStats> workers;
+
+        // sums of all workers, the deque high-water mark is the maximum
+        WorkerStats total() const
+        {
+            WorkerStats sum;
+            for(auto const& worker : workers)
+            {
+                sum += worker;
+            }
+            return sum;
+        }
+    };
+} // namespace rg
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Priority.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rg
+{
+    // one successful steal of a worker
+    struct StealDecision
+    {
+        uint16_t victim = 0;
+        Priority priority = Priority::Normal;
+        // handles moved to the thief, including the one it runs
+        uint32_t items = 0;
+
+        friend bool operator==(StealDecision const&, StealDecision const&) = default;
+    };
+
+    // the random seed of a worker and the steals it made, in order
+    struct WorkerTrace
+    {
+        uint32_t seed = 0;
+        std::vector<StealDecision> steals;
+        // replay only: recorded steals whose victim had nothing to give while the worker found work elsewhere
+        uint64_t diverged = 0;
+    };
+
+    // steal decisions of a pool, recorded with PoolOptions::recordTrace and replayed with PoolOptions::replayTrace.
+    // A replaying worker starts from the recorded seed and tries the recorded victim first in every steal round. The
+    // order of decisions is reproduced, how long tasks take is not, so a replay may diverge where the recorded victim
+    // has no work yet
+    struct SchedulerTrace
+    {
+        std::vector<WorkerTrace> workers;
+
+        // text format: a "worker <seed> <count>" line per worker followed by a "<victim> <priority> <items>" line per
+        // steal
+        void save(std::ostream& out) const
+        {
+            for(auto const& worker : workers)
+            {
+                out << "worker " << worker.seed << ' ' << worker.steals.size() << '\n';
+                for(auto const& steal : worker.steals)
+                {
+                    out << steal.victim << ' ' << static_cast<unsigned>(steal.priority) << ' ' << steal.items << '\n';
+                }
+            }
+        }
+
+        static SchedulerTrace load(std::istream& in)
+        {
+            SchedulerTrace trace;
+            std::string tag;
+            while(in >> tag)
+            {
+                auto& worker = trace.workers.emplace_back();
+                std::size_t count = 0;
+                if(tag != "worker" || !(in >> worker.seed >> count))
+                {
+                    throw std::runtime_error("Malformed scheduler trace.");
+                }
+                // count is not trusted, a corrupt file runs out of entries before it allocates much
+                for(std::size_t i = 0; i < count; ++i)
+                {
+                    auto& steal = worker.steals.emplace_back();
+                    unsigned priority = 0;
+                    if(!(in >> steal.victim >> priority >> steal.items) || priority >= numPriorities)
+                    {
+                        throw std::runtime_error("Malformed scheduler trace.");
+                    }
+                    steal.priority = static_cast<Priority>(priority);
+                }
+            }
+            return trace;
+        }
+    };
+} // namespace rg
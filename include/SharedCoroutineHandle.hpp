@@ -1,5 +1,7 @@
 #pragma once
 
+#include "EventCount.hpp"
+
 #include <atomic>
 #include <cassert>
 #include <coroutine>
@@ -14,6 +16,11 @@ namespace rg
     public:
         using TRefCount = uint32_t;
 
+        // set in the count while a thread waits for the other owners of the frame to let go, see InitTask
+        static constexpr TRefCount joinFlag = TRefCount{1} << 31;
+        // such threads sleep here. The owner that leaves a joining thread as the sole owner wakes them
+        static inline EventCount joiners{};
+
         template<typename PromiseType>
         explicit SharedCoroutineHandle(
             std::coroutine_handle<PromiseType> handle,
@@ -91,10 +98,19 @@ namespace rg
             address_ = nullptr;
             ref_count_ = nullptr;
 
-            if(local_ref_count_copy && local_ref_count_copy->fetch_sub(1, std::memory_order_acq_rel) == 1)
+            if(!local_ref_count_copy)
+            {
+                return;
+            }
+            auto const previous = local_ref_count_copy->fetch_sub(1, std::memory_order_acq_rel);
+            if(previous == 1)
             {
                 std::coroutine_handle<>::from_address(local_address_copy).destroy();
             }
+            else if(previous == (joinFlag | 2))
+            {
+                joiners.notify_all();
+            }
         }
 
         // Checks if the handle is valid
@@ -136,6 +152,12 @@ namespace rg
             return ref_count_;
         }
 
+        // whether this is the only handle to the frame left
+        bool sole_owner() const noexcept
+        {
+            return (ref_count_->load(std::memory_order_acquire) & ~joinFlag) == 1;
+        }
+
 
     private:
         void* address_; // Raw pointer to the coroutine handle
@@ -158,12 +180,21 @@ namespace rg
         // Decrement the reference count and clean up if it reaches zero
         void decrement_ref()
         {
-            if(ref_count_ && ref_count_->fetch_sub(1, std::memory_order_acq_rel) == 1)
+            if(!ref_count_)
+            {
+                return;
+            }
+            auto const previous = ref_count_->fetch_sub(1, std::memory_order_acq_rel);
+            if(previous == 1)
             {
                 ref_count_ = nullptr;
 
                 destroy_coroutine();
             }
+            else if(previous == (joinFlag | 2))
+            {
+                joiners.notify_all();
+            }
         }
     };
 } // namespace rg
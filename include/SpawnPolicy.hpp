@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace rg
+{
+    // what a worker does with a ready child in a non synchronous dispatch_task
+    enum class SpawnPolicy : uint8_t
+    {
+        PoolDefault, // per dispatch hint only: use the policy set on the pool
+        ContinuationStealing, // work first: push the continuation, run the child
+        ChildStealing, // help first: push the child, keep running the continuation
+        Adaptive, // help first while the own deque is shallow, children without resources run inline once it is
+                  // deep or no worker is idle, work first otherwise
+    };
+
+    inline constexpr std::array<std::string_view, 4> spawnPolicyNames
+        = {"default", "continuation", "child", "adaptive"};
+
+    inline constexpr std::string_view toString(SpawnPolicy policy)
+    {
+        return spawnPolicyNames[static_cast<std::size_t>(policy)];
+    }
+
+    // parses the names printed by toString, e.g. for command line arguments
+    inline constexpr std::optional<SpawnPolicy> spawnPolicyFromString(std::string_view name)
+    {
+        for(std::size_t i = 0; i < spawnPolicyNames.size(); ++i)
+        {
+            if(spawnPolicyNames[i] == name)
+            {
+                return static_cast<SpawnPolicy>(i);
+            }
+        }
+        return std::nullopt;
+    }
+} // namespace rg
@@ -2,14 +2,20 @@
 
 #include "CoroAllocator.hpp"
 #include "FinalDelete.hpp"
+#include "PromiseLayout.hpp"
 #include "ResourceNode.hpp"
+#include "ResultSlot.hpp"
 #include "SharedCoroutineHandle.hpp"
+#include "TaskResources.hpp"
+#include "TaskWait.hpp"
 #include "ThreadPool.hpp"
 #include "dispatchTask.hpp"
 
 #include <atomic>
 #include <coroutine>
+#include <optional>
 #include <utility>
+#include <variant>
 
 namespace rg
 {
@@ -45,12 +51,11 @@ namespace rg
             return expectedState != 0;
         }
 
-        // will only be called after the task is done
-        auto await_resume() const noexcept
+        // will only be called after the task is done. The awaiter owns the only handle of the Task, so the result is
+        // moved out
+        T await_resume() const noexcept
         {
-            auto result = coro.promise<AwaitedPromise>().result;
-            coro.promise<AwaitedPromise>().coroOutsideTask = false;
-            return result;
+            return std::move(*coro.promise<AwaitedPromise>().result);
         }
     };
 
@@ -58,41 +63,44 @@ namespace rg
     // returns the value of the callable
     // I want to suspend_always initial_suspend it and then put its handle to the handle stack
     // handle stack will be eaten by the pool
-    // TODO can i hold T as non optional, maybe if it is default constructible
-    template<typename T>
+    // withResources false drops the resource bookkeeping from the promise, see LightTask
+    // resultSlot keeps the result apart from the frame, see SlotTask
+    template<typename T, bool withResources = true, bool resultSlot = false>
     struct Task
     {
-        friend struct Task<void>;
+        template<typename TaskT, bool, bool>
+        friend struct Task;
 
         template<typename U>
         friend struct InitTask;
 
-        template<typename U, bool Synchronous, bool finishedOnReturn>
+        template<typename U, bool Synchronous, bool finishedOnReturn, bool withChildResources>
         friend struct DispatchAwaiter;
 
         template<typename... ResArgs>
         friend struct BarrierAwaiter;
 
+        template<typename TaskT>
+        friend struct BulkDispatchAwaiter;
+
         template<bool Synchronous, bool finishedOnReturn, typename Callable, typename... ResourceAccess>
-        friend auto dispatch_task(Callable&& callable, ResourceAccess&&... accessHandles);
+        friend auto dispatch_task(TaskHints hints, Callable&& callable, ResourceAccess&&... accessHandles);
 
-        struct promise_type
+        // waitCounter and the resource list come from TaskResources, see PromiseLayout.hpp for the layout
+        struct promise_type : TaskResources<withResources>
         {
             using return_type = T;
 
-            // needs to be atomic. multiple threads will change this if deregistering from resources together
-            // start from a large offset, add to it when registering
-            // decrement the offset when registration is done to avoid races which start exec while registering
-            // needs to be atomic. multiple threads will change this if deregistering from resources together
-            alignas(hardware_destructive_interference_size) std::atomic<TWaitCount> waitCounter{INVALID_WAIT_STATE};
             // not incremented in constructor of shared handle
-            alignas(hardware_destructive_interference_size)
-                std::atomic<SharedCoroutineHandle::TRefCount> sharedOwnerCounter{1u};
-            alignas(hardware_destructive_interference_size) std::atomic<uint32_t> workingState{1};
+            alignas(promiseAtomicAlign) std::atomic<SharedCoroutineHandle::TRefCount> sharedOwnerCounter{1u};
+            alignas(promiseAtomicAlign) std::atomic<uint32_t> workingState{1};
 
-            // TODO think should I hold this in task
             // initialized in await_transform of parent coroutine
-            ThreadPool* pool_p{};
+            [[no_unique_address]] TaskPool<> taskPool;
+            // class of the deques this task and its continuations are pushed to, set in dispatch_task
+            Priority priority = Priority::Normal;
+            // where the task itself should run, resolved in dispatch_task
+            Affinity affinity{};
 
             // if .get is called and this coro is not done, add waiter handle here to notify on final suspend
             // someone else waits for the completion of this task.
@@ -104,12 +112,11 @@ namespace rg
             // hold self and reset in final suspend, helps to keep me alive even if returnObj is dead
             SharedCoroutineHandle self;
 
-            // hold res in vector to deregister later
-            std::vector<std::shared_ptr<ResourceNode>> resourceNodes;
-            // does this need to be optional?
-            T result;
-            // true as the return object is always created
-            bool coroOutsideTask = true;
+            // join counter for barriers on the children of this task
+            TaskWait taskWait;
+            // set by return_value, so T needs no default constructor. With resultSlot the promise only holds its
+            // reference to the slot
+            std::conditional_t<resultSlot, ResultSlotRef<T>, std::optional<T>> result;
 
             // using ResourceIDs = typename decltype(callable)::ResourceIDTypeList;
 
@@ -119,6 +126,20 @@ namespace rg
                       std::coroutine_handle<promise_type>::from_promise(*this),
                       sharedOwnerCounter)}
             {
+                if constexpr(resultSlot)
+                {
+                    result.reset(new ResultSlot<T>);
+                }
+            }
+
+            ThreadPool* pool() const noexcept
+            {
+                return taskPool.pool();
+            }
+
+            void set_pool(ThreadPool* pool) noexcept
+            {
+                taskPool.set_pool(pool);
             }
 
             promise_type(promise_type const&) = delete;
@@ -127,16 +148,21 @@ namespace rg
             promise_type& operator=(promise_type&&) = delete;
 
             ~promise_type()
-            { // deregister from resources
-                std::ranges::for_each(
-                    resourceNodes,
-                    [this](auto const& resNode)
-                    { resNode->remove_task(std::coroutine_handle<promise_type>::from_promise(*this), pool_p); });
+            {
+                this->releaseResources(std::coroutine_handle<promise_type>::from_promise(*this), pool());
             }
 
             Task get_return_object()
             {
-                return Task{self};
+                if constexpr(resultSlot)
+                {
+                    // the second reference of the slot
+                    return Task{self, ResultSlotRef<T>{result.get()}};
+                }
+                else
+                {
+                    return Task{self};
+                }
             }
 
             // required to suspend as handle coroutine is created in dispactch task
@@ -148,14 +174,28 @@ namespace rg
 
             FinalDelete final_suspend() noexcept
             {
-                uint32_t expectedState = 1;
-                workingState.compare_exchange_strong(expectedState, 0);
-                // contHandle has been pushed already
-                if(expectedState == 2)
+                this->recordWriter(pool());
+                // the body is done, barriers only wait for the children from here on
+                taskWait.release();
+                // a get on the slot only waits if the Task was handed out before, never together with a continuation
+                // of the body. The frame is not needed for the result from here on
+                std::coroutine_handle<> slotAwaiter = nullptr;
+                if constexpr(resultSlot)
+                {
+                    slotAwaiter = result->complete();
+                    result.reset();
+                }
+                // 2 if a continuation waits for the body, contHandle has been pushed already. The state is left at 0
+                // either way, so a get after an inline run finds the task done
+                if(workingState.exchange(0, std::memory_order_acq_rel) == 2)
                 {
                     return {std::move(self), continuationHandle};
                     // when continuation is finally resumed, await_resume will take out the value
                 }
+                if(slotAwaiter)
+                {
+                    return {std::move(self), slotAwaiter};
+                }
                 return {std::move(self)};
             }
 
@@ -168,15 +208,22 @@ namespace rg
             template<typename U>
             void return_value(U&& value)
             {
-                result = std::forward<U>(value);
+                if constexpr(resultSlot)
+                {
+                    result->result.emplace(std::forward<U>(value));
+                }
+                else
+                {
+                    result.emplace(std::forward<U>(value));
+                }
             }
 
             // TODO contrain args to resource concept
             // TODO PASS BY REF? also in init
             // Called by children of this task
             // TODO think abour using a concept
-            template<typename U, bool Synchronous, bool finishedOnReturn>
-            auto& await_transform(DispatchAwaiter<U, Synchronous, finishedOnReturn>& awaiter)
+            template<typename U, bool Synchronous, bool finishedOnReturn, bool withChildResources>
+            auto await_transform(DispatchAwaiter<U, Synchronous, finishedOnReturn, withChildResources>&& awaiter)
             {
                 // Init
                 auto& awaiter_promise
@@ -185,12 +232,13 @@ namespace rg
                 // pass in the parent task space
                 // coro.promise().space->parentSpace = space;
                 // pass in the pool ptr
-                awaiter_promise.pool_p = pool_p;
+                awaiter_promise.set_pool(pool());
 
                 // coro.promise().space->ownerHandle = coro.getHandle();
                 if constexpr(!finishedOnReturn)
                 {
                     awaiter_promise.parent = self;
+                    taskWait.add_child(awaiter_promise.taskWait);
                 }
 
                 // Init over
@@ -205,11 +253,11 @@ namespace rg
                 // elseif resources not ready
                 //   task has been initialized with wait counter, waits for child notification to add to ready queue
                 //   return awaiter that suspend never (executes the continuation)
-                return awaiter;
+                return std::move(awaiter);
             }
 
             template<typename NonDispatchAwaiter>
-            auto await_transform(NonDispatchAwaiter&& aw)
+            decltype(auto) await_transform(NonDispatchAwaiter&& aw)
             {
                 return std::forward<NonDispatchAwaiter>(aw);
             }
@@ -234,15 +282,20 @@ namespace rg
         {
         }
 
+        Task(SharedCoroutineHandle const& h, ResultSlotRef<T> resultSlotRef) noexcept
+            : coro(h)
+            , slot{std::move(resultSlotRef)}
+        {
+        }
+
         Task() noexcept : coro()
         {
         }
 
         Task(Task const& x) = delete;
 
-        Task(Task&& x) noexcept : coro{std::move(x.coro)}
+        Task(Task&& x) noexcept : coro{std::move(x.coro)}, slot{std::move(x.slot)}
         {
-            x.isMoved = true;
         }
 
         Task& operator=(Task const& x) = delete;
@@ -250,71 +303,98 @@ namespace rg
         Task& operator=(Task&& x) noexcept
         {
             coro = std::move(x.coro);
-            x.isMoved = true;
+            slot = std::move(x.slot);
             return *this;
         }
 
-        ~Task() noexcept
-        {
-            if(!isMoved && coro)
-            {
-                coro.promise<promise_type>().coroOutsideTask = false;
-            }
-        }
+        ~Task() noexcept = default;
 
         // TODO put some of the on get destruction logic in destructor as well. If destroying the object without
         // calling get,
-        auto get() -> GetAwaiter<T, promise_type>
+        // moves the result out once the task is done, so get can only be called once
+        auto get()
         {
-            // moved coro, calling get again is an error
-            auto awaiter = GetAwaiter<T, promise_type>{std::move(coro)};
-            // task holds self. Get called.
-            // Set coro to nullptr.
-            // TODO get cannot be called twice
-            // make sure coro isnt used again by the handle. Either destroyed or owned by the execution space
-            return awaiter;
+            if constexpr(resultSlot)
+            {
+                return SlotGetAwaiter<T>{std::move(slot)};
+            }
+            else
+            {
+                // moved coro, calling get again is an error
+                // make sure coro isnt used again by the handle. Either destroyed or owned by the execution space
+                return GetAwaiter<T, promise_type>{std::move(coro)};
+            }
         }
 
     private:
         SharedCoroutineHandle coro;
-        bool isMoved = false;
+        // the reference of the Task to its result slot
+        [[no_unique_address]] std::conditional_t<resultSlot, ResultSlotRef<T>, std::monostate> slot;
+
+        // the result of a finished task, for synchronous dispatches
+        T take_result() noexcept
+        {
+            if constexpr(resultSlot)
+            {
+                return std::move(*slot->result);
+            }
+            else
+            {
+                return std::move(*coro.promise<promise_type>().result);
+            }
+        }
+
+        // called once the task is published. A task keeps its frame alive until it is done, with a result slot the
+        // Task has no use for the frame from here on
+        void drop_frame() noexcept
+        {
+            if constexpr(resultSlot)
+            {
+                coro.reset();
+            }
+        }
     };
 
-    template<>
-    struct Task<void>
+    // a void task has no result, with resultSlot it only lets go of its frame like a SlotTask
+    template<bool withResources, bool resultSlot>
+    struct Task<void, withResources, resultSlot>
     {
-        template<typename TaskT>
+        template<typename TaskT, bool, bool>
         friend struct Task;
 
         template<typename U>
         friend struct InitTask;
 
-        template<typename U, bool Synchronous, bool finishedOnReturn>
+        template<typename U, bool Synchronous, bool finishedOnReturn, bool withChildResources>
         friend struct DispatchAwaiter;
 
         template<typename... ResArgs>
         friend struct BarrierAwaiter;
 
+        template<typename TaskT>
+        friend struct BulkDispatchAwaiter;
+
         template<bool Synchronous, bool finishedOnReturn, typename Callable, typename... ResourceAccess>
-        friend auto dispatch_task(Callable&& callable, ResourceAccess&&... accessHandles);
+        friend auto dispatch_task(TaskHints hints, Callable&& callable, ResourceAccess&&... accessHandles);
+
+        template<typename Callable, typename... Args>
+        friend auto submit(ThreadPool* pool_p, TaskHints hints, Callable&& callable, Args&&... args);
 
-        struct promise_type
+        // waitCounter and the resource list come from TaskResources, see PromiseLayout.hpp for the layout
+        struct promise_type : TaskResources<withResources>
         {
             using return_type = void;
 
-            // needs to be atomic. multiple threads will change this if deregistering from resources together
-            // start from a large offset, add to it when registering
-            // decrement the offset when registration is done to avoid races which start exec while registering
-            // needs to be atomic. multiple threads will change this if deregistering from resources together
-            alignas(hardware_destructive_interference_size) std::atomic<TWaitCount> waitCounter{INVALID_WAIT_STATE};
             // not incremented in constructor of shared handle
-            alignas(hardware_destructive_interference_size)
-                std::atomic<SharedCoroutineHandle::TRefCount> sharedOwnerCounter{1u};
-            alignas(hardware_destructive_interference_size) std::atomic<uint32_t> workingState{1};
+            alignas(promiseAtomicAlign) std::atomic<SharedCoroutineHandle::TRefCount> sharedOwnerCounter{1u};
+            alignas(promiseAtomicAlign) std::atomic<uint32_t> workingState{1};
 
-            // TODO think should I hold this in task
             // initialized in await_transform of parent coroutine
-            ThreadPool* pool_p{};
+            [[no_unique_address]] TaskPool<> taskPool;
+            // class of the deques this task and its continuations are pushed to, set in dispatch_task
+            Priority priority = Priority::Normal;
+            // where the task itself should run, resolved in dispatch_task
+            Affinity affinity{};
             // if .get is called and this coro is not done, add waiter handle here to notify on final suspend
             // someone else waits for the completion of this task.
             std::coroutine_handle<> continuationHandle{nullptr};
@@ -325,10 +405,8 @@ namespace rg
             // hold self and reset in final suspend, helps to keep me alive even if returnObj is dead
             SharedCoroutineHandle self;
 
-            // hold res in vector to deregister later
-            std::vector<std::shared_ptr<ResourceNode>> resourceNodes;
-            // true as the return object is always created
-            bool coroOutsideTask = true;
+            // join counter for barriers on the children of this task
+            TaskWait taskWait;
 
             // using ResourceIDs = typename decltype(callable)::ResourceIDTypeList;
 
@@ -340,17 +418,24 @@ namespace rg
             {
             }
 
+            ThreadPool* pool() const noexcept
+            {
+                return taskPool.pool();
+            }
+
+            void set_pool(ThreadPool* pool) noexcept
+            {
+                taskPool.set_pool(pool);
+            }
+
             promise_type(promise_type const&) = delete;
             promise_type(promise_type&&) = delete;
             promise_type& operator=(promise_type const&) = delete;
             promise_type& operator=(promise_type&&) = delete;
 
             ~promise_type()
-            { // deregister from resources
-                std::ranges::for_each(
-                    resourceNodes,
-                    [this](auto const& resNode)
-                    { resNode->remove_task(std::coroutine_handle<promise_type>::from_promise(*this), pool_p); });
+            {
+                this->releaseResources(std::coroutine_handle<promise_type>::from_promise(*this), pool());
             }
 
             Task get_return_object()
@@ -367,11 +452,12 @@ namespace rg
 
             FinalDelete final_suspend() noexcept
             {
+                this->recordWriter(pool());
+                // the body is done, barriers only wait for the children from here on
+                taskWait.release();
                 // get is never called, but void tasks may be called synchronously
-                uint32_t expectedState = 1;
-                workingState.compare_exchange_strong(expectedState, 0);
-                // contHandle has been pushed already
-                if(expectedState == 2)
+                // 2 if a continuation waits for the body, contHandle has been pushed already
+                if(workingState.exchange(0, std::memory_order_acq_rel) == 2)
                 {
                     return {std::move(self), continuationHandle};
                 }
@@ -391,8 +477,8 @@ namespace rg
             // TODO PASS BY REF? also in init
             // Called by children of this task
             // TODO think abour using a concept
-            template<typename U, bool finishedOnReturn>
-            auto& await_transform(DispatchAwaiter<U, finishedOnReturn>& awaiter)
+            template<typename U, bool Synchronous, bool finishedOnReturn, bool withChildResources>
+            auto await_transform(DispatchAwaiter<U, Synchronous, finishedOnReturn, withChildResources>&& awaiter)
             {
                 // Init
                 auto& awaiter_promise
@@ -401,12 +487,13 @@ namespace rg
                 // pass in the parent task space
                 // coro.promise().space->parentSpace = space;
                 // pass in the pool ptr
-                awaiter_promise.pool_p = pool_p;
+                awaiter_promise.set_pool(pool());
 
                 // coro.promise().space->ownerHandle = coro.getHandle();
                 if constexpr(!finishedOnReturn)
                 {
                     awaiter_promise.parent = self;
+                    taskWait.add_child(awaiter_promise.taskWait);
                 }
 
                 // Init over
@@ -421,11 +508,11 @@ namespace rg
                 // elseif resources not ready
                 //   task has been initialized with wait counter, waits for child notification to add to ready queue
                 //   return awaiter that suspend never (executes the continuation)
-                return awaiter;
+                return std::move(awaiter);
             }
 
             template<typename NonDispatchAwaiter>
-            auto await_transform(NonDispatchAwaiter&& aw)
+            decltype(auto) await_transform(NonDispatchAwaiter&& aw)
             {
                 return std::forward<NonDispatchAwaiter>(aw);
             }
@@ -458,7 +545,6 @@ namespace rg
 
         Task(Task&& x) noexcept : coro{std::move(x.coro)}
         {
-            x.isMoved = true;
         }
 
         Task& operator=(Task const& x) = delete;
@@ -466,21 +552,33 @@ namespace rg
         Task& operator=(Task&& x) noexcept
         {
             coro = std::move(x.coro);
-            x.isMoved = true;
             return *this;
         }
 
-        ~Task() noexcept
+        ~Task() noexcept = default;
+
+
+    private:
+        SharedCoroutineHandle coro;
+
+        // see Task::drop_frame
+        void drop_frame() noexcept
         {
-            if(!isMoved && coro)
+            if constexpr(resultSlot)
             {
-                coro.promise<promise_type>().coroOutsideTask = false;
+                coro.reset();
             }
         }
+    };
 
+    // a task that never takes resources. Its promise carries no wait counter and no resource nodes, dispatching it
+    // with a resource access does not compile
+    template<typename T>
+    using LightTask = Task<T, false>;
 
-    private:
-        SharedCoroutineHandle coro;
-        bool isMoved = false;
-    };
+    // a task whose result goes to a ResultSlot of its own. The Task only holds the slot once it is dispatched, so the
+    // frame and the resources of the task are freed when it is done and not when the result is taken. Costs one more
+    // allocation per task, meant for small results of tasks whose Task is held for long
+    template<typename T, bool withResources = true>
+    using SlotTask = Task<T, withResources, true>;
 } // namespace rg
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Affinity.hpp"
+#include "Priority.hpp"
+#include "SpawnPolicy.hpp"
+
+namespace rg
+{
+    // per dispatch scheduling hints, passed as the first argument of dispatch_task
+    // children do not inherit the hints of their parent
+    struct TaskHints
+    {
+        Priority priority = Priority::Normal;
+        SpawnPolicy spawn = SpawnPolicy::PoolDefault;
+        Affinity affinity{};
+    };
+} // namespace rg
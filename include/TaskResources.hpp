@@ -0,0 +1,108 @@
+#pragma once
+
+#include "PromiseLayout.hpp"
+#include "ResourceNode.hpp"
+#include "ThreadPool.hpp"
+#include "waitCounter.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace rg
+{
+    // resource nodes of a task and which of them it writes
+    struct ResourceList
+    {
+        // hold res in vector to deregister later
+        std::vector<std::shared_ptr<ResourceNode>> nodes;
+        // nodes this task writes, see writeBit
+        uint64_t writeMask = 0;
+        // pool final_suspend ran on, the compact layout has no other record of it once the frame goes away
+        ThreadPool* pool_p{};
+    };
+
+    // resource bookkeeping of a task promise. The promise of a LightTask uses the empty specialization, such tasks
+    // never take resources and dispatch_task skips their registration at compile time
+    template<bool withResources, bool compact = compactPromise>
+    struct TaskResources
+    {
+        static constexpr bool takesResources = true;
+
+        // needs to be atomic. multiple threads will change this if deregistering from resources together
+        // start from a large offset, add to it when registering
+        // decrement the offset when registration is done to avoid races which start exec while registering
+        alignas(promiseAtomicAlign) std::atomic<TWaitCount> waitCounter{INVALID_WAIT_STATE};
+
+        // the compact layout allocates the list with the first registration
+        ResourceList& resources()
+        {
+            if constexpr(compact)
+            {
+                if(!list)
+                {
+                    list = std::make_unique<ResourceList>();
+                }
+                return *list;
+            }
+            else
+            {
+                return list;
+            }
+        }
+
+        // called from final_suspend
+        void recordWriter(ThreadPool* pool_p) noexcept
+        {
+            if constexpr(compact)
+            {
+                if(list)
+                {
+                    list->pool_p = pool_p;
+                    recordLastWriter(list->nodes, list->writeMask, pool_p);
+                }
+            }
+            else
+            {
+                recordLastWriter(list.nodes, list.writeMask, pool_p);
+            }
+        }
+
+        // deregister from resources, called when the frame goes away
+        void releaseResources(std::coroutine_handle<> h, ThreadPool* pool_p)
+        {
+            if constexpr(compact)
+            {
+                if(!list)
+                {
+                    return;
+                }
+                pool_p = list->pool_p;
+            }
+            for(auto const& resNode : resources().nodes)
+            {
+                resNode->remove_task(h, pool_p);
+            }
+        }
+
+    private:
+        std::conditional_t<compact, std::unique_ptr<ResourceList>, ResourceList> list;
+    };
+
+    template<bool compact>
+    struct TaskResources<false, compact>
+    {
+        static constexpr bool takesResources = false;
+
+        void recordWriter(ThreadPool*) noexcept
+        {
+        }
+
+        void releaseResources(std::coroutine_handle<>, ThreadPool*) noexcept
+        {
+        }
+    };
+} // namespace rg
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Priority.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+namespace rg
+{
+    // Join counter of a task, used for taskwait barriers.
+    // Counts the task body itself and every child whose subtree has not completed yet. The last child to complete
+    // reschedules a waiting body directly, and a completed subtree releases its slot in the parent counter.
+    struct TaskWait
+    {
+        // set while the body is suspended in a barrier
+        static constexpr uint32_t waitingFlag = 1u << 31;
+
+        // 1 for the running body
+        std::atomic<uint32_t> pending{1};
+        // body suspended in the barrier, and the pool to resume it on
+        std::coroutine_handle<> waiter{};
+        ThreadPool* waiterPool{};
+        Priority waiterPriority = Priority::Normal;
+        // counter of the parent task, released once this subtree is complete
+        TaskWait* parent{};
+        // called once the subtree is complete, after which the counter is not touched again. Nodes that are not part
+        // of a frame, like the join of a task group, free themselves here
+        void (*completed)(TaskWait&){};
+
+        TaskWait() = default;
+        TaskWait(TaskWait const&) = delete;
+        TaskWait(TaskWait&&) = delete;
+        TaskWait& operator=(TaskWait const&) = delete;
+        TaskWait& operator=(TaskWait&&) = delete;
+
+        // called by the body before the child can run
+        void add_child(TaskWait& child) noexcept
+        {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            child.parent = this;
+        }
+
+        // for a child that cannot have children of its own, like a plain call. It calls release when it is done
+        void add_leaf() noexcept
+        {
+            pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // called once by the body when it finishes, and once per child subtree when it completes
+        void release() noexcept
+        {
+            auto prev = pending.fetch_sub(1, std::memory_order_acq_rel);
+            if(prev == waitingFlag + 2)
+            {
+                // the waiting body is the only one left. It is suspended and cannot add children, so clearing the
+                // flag here cannot race
+                auto h = waiter;
+                auto* pool_p = waiterPool;
+                auto priority = waiterPriority;
+                pending.fetch_sub(waitingFlag, std::memory_order_relaxed);
+                pool_p->addTask(h, priority);
+            }
+            else if(prev == 1)
+            {
+                auto* up = parent;
+                if(completed)
+                {
+                    completed(*this);
+                }
+                if(up)
+                {
+                    up->release();
+                }
+            }
+        }
+
+        // called by the body from await_suspend. Returns false if there is nothing to wait for
+        bool wait(std::coroutine_handle<> h, ThreadPool* pool_p, Priority priority) noexcept
+        {
+            waiter = h;
+            waiterPool = pool_p;
+            waiterPriority = priority;
+            if(pending.fetch_add(waitingFlag, std::memory_order_acq_rel) == 1)
+            {
+                // no children
+                pending.fetch_sub(waitingFlag, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+    };
+} // namespace rg
@@ -1,7 +1,17 @@
 #pragma once
 
-// #include "MPMCQueue.hpp"
-#include "BarrierQueue.hpp"
+#include "Affinity.hpp"
+#include "EventCount.hpp"
+#include "MPMCQueue.hpp"
+#include "Placement.hpp"
+#include "PoolOptions.hpp"
+#include "Priority.hpp"
+#include "PriorityDeque.hpp"
+#include "SchedulerStats.hpp"
+#include "SchedulerTrace.hpp"
+#include "SpawnPolicy.hpp"
+#include "TimerWheel.hpp"
+#include "VictimOrder.hpp"
 #include "dequeue.hpp"
 #include "hwloc_ctx.hpp"
 #include "random.hpp"
@@ -10,20 +20,44 @@
 #include <hwloc.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <concepts>
 #include <coroutine>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <random>
+#include <span>
+#include <stdexcept>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace rg
 {
-
-    // if size is known at compile time, get it from init as template param and use it for faster containers
-    constexpr uint32_t threadPoolStackSize = 64u;
-    constexpr uint32_t randomStealAttempts = 64u;
+    // steal attempts per round, spread over as many sweeps through the victim order as fit
+    constexpr uint32_t stealAttempts = 64u;
+    // most items moved to the thief's own deque per steal
+    constexpr int64_t maxStealBatch = 32;
+    // failed pop/steal rounds a worker spins through before it parks
+    constexpr uint32_t idleSpinRounds = 16u;
+    // every agingPeriod-th pop or steal of a worker serves the lowest non-empty priority class first
+    constexpr uint32_t agingPeriod = 32u;
+    // most injected tasks a worker moves to its own deque per poll
+    constexpr std::size_t maxInjectBatch = 32u;
+    // most pools the idle workers of one pool may lend themselves to
+    constexpr std::size_t maxLendTargets = 8u;
+    // tries at the recorded victim before a replaying worker gives up on a decision
+    constexpr uint32_t replayPatience = 64u;
+    // routed tasks waiting for a last writer beyond which readied tasks stay with the releasing worker
+    constexpr std::size_t lastWriterBacklog = 4u;
+    // own deque depth from which the adaptive spawn policy stops pushing children and runs them inline
+    constexpr std::size_t adaptiveSpawnDepth = 8u;
 
     // TODO SPECIFY PROMISE TYPE IN COROUTINE HANDLE
     struct ThreadPool
@@ -31,53 +65,167 @@ namespace rg
         // using stack_type
         //     = boost::lockfree::stack<std::coroutine_handle<>, boost::lockfree::capacity<threadPoolStackSize>>;
         // using stack_type = rigtorp::MPMCQueue<std::coroutine_handle<>>;
-        using stack_type = riften::Deque<std::coroutine_handle<>>;
-
-        template<typename... ResArgs>
-        friend struct BarrierAwaiter;
+        // one deque per priority class
+        using stack_type = PriorityDeque;
 
     private:
+        // task submitted by a thread that is not a worker of this pool
+        struct InjectedTask
+        {
+            std::coroutine_handle<> handle{};
+            Priority priority = Priority::Normal;
+        };
+
+        // what the calling thread is to the pools of the process. Zero initialized like every thread_local, so it is
+        // empty outside of workers. A thread is a worker of at most one pool
+        struct WorkerContext
+        {
+            ThreadPool* pool;
+            stack_type* queue;
+            WorkerCounters* stats;
+            uint16_t index;
+        };
+
         // bitfield where 0 is free and 1 is busy
         // std::atomic<uint64_t> worker_states{0};
-        thread_local static inline stack_type* thread_queue_p;
+        thread_local static inline WorkerContext context;
+        // pool whose task the calling thread runs, see running_pool
+        thread_local static inline ThreadPool* running{};
         std::vector<std::unique_ptr<stack_type>> thread_queues;
-        stack_type master_queue{threadPoolStackSize};
-        BarrierQueue barrier_queue{};
+        // any thread may push here, workers poll it every aging period and before they steal
+        rigtorp::MPMCQueue<InjectedTask> injection_queue;
+        // tasks with an affinity for a worker. Only the owner takes from its inbox, nobody steals from it
+        std::vector<std::unique_ptr<rigtorp::MPMCQueue<InjectedTask>>> inboxes;
+        // readied tasks routed to the last writer of their resource, see addReadyTask. The owner runs them before it
+        // steals, other workers take them once a steal round came up empty, so a busy writer holds none up
+        std::vector<std::unique_ptr<rigtorp::MPMCQueue<InjectedTask>>> routed;
+        // handles that yielded, oldest first. Only the owner touches them, they run once it found nothing else
+        std::vector<std::deque<std::coroutine_handle<>>> yielded;
+        // OS index of the NUMA node of every worker, -1 if unknown, and the workers of every node
+        std::vector<int> worker_numa;
+        std::vector<std::vector<uint16_t>> numa_workers;
+        // round robin position within the workers of a node
+        std::unique_ptr<std::atomic<uint32_t>[]> numa_next;
+        // tasks sleeping in rg::sleep_for and rg::sleep_until. Workers poll it when they run out of local work and
+        // every aging period, one parked worker sleeps with a timeout until the next expiry
+        std::mutex timer_mutex;
+        TimerWheel timers;
+        // tick at which the wheel has something to do next, TimerWheel::never while it is empty
+        std::atomic<uint64_t> timer_deadline{TimerWheel::never};
+        std::atomic<bool> timer_sleeper{false};
+        std::chrono::steady_clock::time_point timer_epoch;
+        std::chrono::nanoseconds timer_tick;
+        // idle workers park here, addTask wakes one sleeper per pushed task
+        EventCount idle_workers{};
+        // workers with an index from active_workers on are retired. They drain their own deque and then sleep here
+        // until the pool grows again. Their deques stay in place, so victim orders and thieves never see a change
+        std::atomic<std::size_t> active_workers;
+        EventCount retired_workers{};
+        // elastic pools keep at least this many workers active, 0 keeps the worker count where it is set
+        std::size_t min_workers;
+        uint32_t retire_after_parks;
+        // readied tasks without an affinity go to the inbox of the last writer of their resource, see addReadyTask
+        std::atomic<bool> last_writer_routing;
+        // per worker victims, nearest first
+        std::vector<VictimOrder> victim_orders;
+        // used by dispatches without a spawn hint
+        std::atomic<SpawnPolicy> spawn_policy{SpawnPolicy::ContinuationStealing};
+
+        // successful steals by locality, only written by the owning worker
+        struct alignas(hardware_destructive_interference_size) StealCounters
+        {
+            std::array<std::atomic<uint64_t>, numStealLocalities> count{};
+        };
+
+        std::unique_ptr<StealCounters[]> steal_counters;
+
+        struct alignas(hardware_destructive_interference_size) PaddedCounters : WorkerCounters
+        {
+        };
+
+        // scheduler statistics, one slot per worker
+        std::unique_ptr<PaddedCounters[]> worker_counters;
+
+        // seed and steals of a worker. The lock is only taken when tracing, and then uncontended unless trace() runs
+        struct alignas(hardware_destructive_interference_size) TraceSlot
+        {
+            std::mutex mtx;
+            WorkerTrace trace;
+            // next recorded steal to replay
+            std::size_t replayCursor = 0;
+        };
+
+        std::unique_ptr<TraceSlot[]> traces;
+        bool record_trace;
+        std::shared_ptr<SchedulerTrace const> replay_trace;
+
+        // pools whose tasks idle workers of this pool may run, see lend_to. Reserved up front and only appended to,
+        // so workers can read the first lend_count entries while another one is added
+        std::array<std::atomic<ThreadPool*>, maxLendTargets> lend_targets{};
+        std::atomic<std::size_t> lend_count{0};
+        std::mutex lend_mutex;
+        // workers of other pools currently running a task of this pool, and how many may at once
+        std::atomic<uint32_t> borrowed{0};
+        std::atomic<uint32_t> borrow_quota;
         // stack_type stack{threadPoolStackSize};
         // stack_type readyQueue{threadPoolStackSize};
         std::stop_source stop_source;
         std::vector<std::jthread> threads;
         hwloc_topology_t const& topology;
+        // cpuset each worker is bound to
+        std::vector<CpuSet> places;
 
     public:
-        explicit ThreadPool(std::unsigned_integral auto size) : topology(HwlocTopology::getInstance())
+        explicit ThreadPool(std::unsigned_integral auto size, PoolOptions const& options = {})
+            : injection_queue(std::max<std::size_t>(options.injectionCapacity, 1))
+            , timer_epoch(std::chrono::steady_clock::now())
+            , timer_tick(std::max<std::chrono::nanoseconds>(options.timerTick, std::chrono::nanoseconds(1)))
+            , active_workers(size)
+            , min_workers(options.minWorkers < size ? options.minWorkers : 0)
+            , retire_after_parks(std::max<uint32_t>(options.retireAfterParks, 1))
+            , last_writer_routing(options.lastWriterRouting)
+            , record_trace(options.recordTrace)
+            , replay_trace(options.replayTrace)
+            , borrow_quota(options.borrowQuota)
+            , topology(HwlocTopology::getInstance())
         {
-            int num_cores = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_CORE);
-            if(num_cores < static_cast<int>(size))
+            if(size == 0)
             {
-                throw std::runtime_error("Insufficient cores for thread pool size.");
+                throw std::invalid_argument("A pool needs at least one worker.");
             }
+            initSeeds(size, options.seed);
+            places = computePlaces(topology, size, options.placement);
 
-            // set thread queue p for main thread
-            thread_queue_p = &master_queue;
             thread_queues.reserve(size);
             std::generate_n(
                 std::back_inserter(thread_queues),
                 size,
-                [] { return std::make_unique<stack_type>(threadPoolStackSize); });
+                [capacity = options.roundedQueueCapacity()] { return std::make_unique<stack_type>(capacity); });
+
+            std::vector<hwloc_obj_t> placeObjs;
+            placeObjs.reserve(size);
+            std::ranges::transform(
+                places,
+                std::back_inserter(placeObjs),
+                [this](CpuSet const& place) { return placeObject(topology, place); });
+            victim_orders = buildVictimOrders(topology, placeObjs);
+            initAffinity(placeObjs, std::max<std::size_t>(options.inboxCapacity, 1));
+            yielded.resize(size);
+            steal_counters = std::make_unique<StealCounters[]>(size);
+            worker_counters = std::make_unique<PaddedCounters[]>(size);
 
             threads.reserve(size);
             uint16_t i = 0;
             std::generate_n(
                 std::back_inserter(threads),
                 size,
-                [this, &i, num_cores]
+                [this, &i]
                 {
                     return std::jthread(
-                        [this, idx = i++, num_cores](std::stop_token stoken)
+                        [this, idx = i++](std::stop_token stoken)
                         {
-                            // Pin thread to core
-                            ThreadPool::pinThreadToCore(idx % num_cores);
+                            // Pin thread to its place
+                            ThreadPool::pinThread(idx);
                             ThreadPool::worker(idx, stoken);
                         });
                 }
@@ -85,13 +233,33 @@ namespace rg
             );
         }
 
+        ThreadPool(std::unsigned_integral auto size, Placement const& placement)
+            : ThreadPool(size, PoolOptions{placement})
+        {
+        }
+
         ~ThreadPool()
+        {
+            shutdown();
+        }
+
+        // stops and joins the workers, tasks still queued are dropped. Pools lending workers to each other have to be
+        // shut down before any of them is destroyed, see Arenas
+        void shutdown()
         {
             // std::cout << "pool destructor called" << std::endl;
             // while(!done())
             // {
             // }
             stop_source.request_stop();
+            // workers observe the stop token of their own jthread. Request stop on all of them before joining any,
+            // and wake the parked ones so they can see it
+            for(auto& thread : threads)
+            {
+                thread.request_stop();
+            }
+            idle_workers.notify_all();
+            retired_workers.notify_all();
             // Ensure all threads are joined and destroyed. Not needed if order of destruction is correct
             threads.clear();
             // threads.clear();
@@ -101,9 +269,339 @@ namespace rg
             // cv.notify_one();
         }
 
-        void addTask(std::coroutine_handle<> h)
+        // safe from any thread. Workers of this pool push to their own deque, everyone else goes through the
+        // injection queue
+        void addTask(std::coroutine_handle<> h, Priority priority = Priority::Normal, Affinity const& affinity = {})
+        {
+            if(affinity && routeToInbox(h, priority, affinity))
+            {
+                return;
+            }
+            if(context.pool == this)
+            {
+                context.queue->emplace(h, priority);
+            }
+            else
+            {
+                injection_queue.push(InjectedTask{h, priority});
+            }
+            recordStat(&WorkerCounters::tasks_pushed);
+            idle_workers.notify_one();
+        }
+
+        // pushes a batch of tasks of one class and wakes up to as many sleepers in one go, see dispatch_bulk
+        void addTasks(std::span<std::coroutine_handle<> const> handles, Priority priority)
+        {
+            if(context.pool == this)
+            {
+                for(auto h : handles)
+                {
+                    context.queue->emplace(h, priority);
+                }
+            }
+            else
+            {
+                for(auto h : handles)
+                {
+                    injection_queue.push(InjectedTask{h, priority});
+                }
+            }
+            recordStat(&WorkerCounters::tasks_pushed, handles.size());
+            idle_workers.notify(static_cast<uint32_t>(std::min<std::size_t>(handles.size(), thread_queues.size())));
+        }
+
+        // index of the calling worker in its pool, -1 outside of workers
+        static int32_t current_worker() noexcept
+        {
+            return context.pool ? context.index : -1;
+        }
+
+        // pool of the calling worker, nullptr outside of workers
+        static ThreadPool* current_pool() noexcept
+        {
+            return context.pool;
+        }
+
+        // pool whose tasks the calling thread runs right now: the own pool on a worker, the lending pool while a
+        // worker runs a borrowed task and the helped pool in helpUntil. nullptr on other threads
+        static ThreadPool* running_pool() noexcept
+        {
+            return running;
+        }
+
+        // true if the deque of the calling worker ran empty while other workers are active, so work split off now
+        // is what a thief would find. The check behind the lazy binary splitting of parallel.hpp. Threads outside of
+        // the pools have no deque to steal from, their splits always go to the injection queue
+        static bool split_wanted() noexcept
+        {
+            if(!context.pool)
+            {
+                return true;
+            }
+            return context.pool->active_workers.load(std::memory_order_relaxed) > 1 && context.queue->size() == 0;
+        }
+
+        // index of the calling worker if it belongs to this pool, -1 otherwise
+        int32_t calling_worker() const noexcept
+        {
+            return context.pool == this ? context.index : -1;
+        }
+
+        // a task whose last resource dependency was just released. Without an affinity of its own it follows the
+        // data to the worker that last wrote the resource, unless that worker already has a backlog of routed tasks.
+        // Routing is only a preference, idle workers take routed tasks the last writer does not get to. A releasing
+        // worker that is the last writer keeps the task in its own deque, where thieves can balance it
+        void addReadyTask(std::coroutine_handle<> h, Priority priority, Affinity affinity, int32_t lastWriter)
+        {
+            // the resource may be shared with another pool, whose worker indices mean nothing here
+            if(!affinity && lastWriter >= 0 && static_cast<std::size_t>(lastWriter) < routed.size()
+               && last_writer_routing.load(std::memory_order_relaxed) && lastWriter != calling_worker()
+               && static_cast<std::size_t>(lastWriter) < active_workers.load(std::memory_order_acquire)
+               && routed[static_cast<std::size_t>(lastWriter)]->try_push(InjectedTask{h, priority}))
+            {
+                recordStat(&WorkerCounters::tasks_pushed);
+                // the event count cannot wake a particular worker, wake them all so the last writer gets a chance
+                idle_workers.notify_all();
+                return;
+            }
+            addTask(h, priority, affinity);
+        }
+
+        // parks a handle that gives its worker back until the worker ran out of other work, see rg::yield. Outside
+        // of the workers of this pool there is no worker to give back, the handle is pushed like any other
+        void yieldTask(std::coroutine_handle<> h, Priority priority)
+        {
+            if(context.pool != this)
+            {
+                addTask(h, priority);
+                return;
+            }
+            recordStat(&WorkerCounters::tasks_yielded);
+            yielded[context.index].push_back(h);
+        }
+
+        // whether a task of the given class running on the calling worker holds up other work: a higher class
+        // waits in the own deque, a task was routed to this worker, or submitted tasks wait while no worker is idle
+        bool yieldWanted(Priority priority) const noexcept
+        {
+            if(context.pool != this)
+            {
+                return false;
+            }
+            for(std::size_t p = 0; p < static_cast<std::size_t>(priority); ++p)
+            {
+                if(!(*context.queue)[static_cast<Priority>(p)].empty())
+                {
+                    return true;
+                }
+            }
+            return !inboxes[context.index]->empty()
+                   || !routed[context.index]->empty()
+                   || (!injection_queue.empty() && idle_workers.num_waiters() == 0);
+        }
+
+        // resumes h in the given class once deadline passed, without holding a worker meanwhile. Returns false if
+        // the deadline is due already, the caller continues h itself then
+        bool addTimer(std::coroutine_handle<> h, Priority priority, std::chrono::steady_clock::time_point deadline)
+        {
+            auto const expiry = deadline <= timer_epoch
+                                    ? 0
+                                    : (deadline - timer_epoch + timer_tick - std::chrono::nanoseconds(1)) / timer_tick;
+            std::lock_guard lock(timer_mutex);
+            if(!timers.schedule({h, priority, static_cast<uint64_t>(expiry)}))
+            {
+                return false;
+            }
+            auto const next = timers.next_expiry();
+            if(next < timer_deadline.exchange(next, std::memory_order_acq_rel))
+            {
+                // a worker parked until a later expiry would oversleep this one. Without such a worker, one parked
+                // without a timeout has to take over the timers, the caller may not be a worker that polls them
+                if(timer_sleeper.load(std::memory_order_acquire))
+                {
+                    idle_workers.notify_all();
+                }
+                else
+                {
+                    idle_workers.notify_one();
+                }
+            }
+            return true;
+        }
+
+        // lets a thread that waits for the pool, like the owner of an InitTask, run injected and stolen tasks until
+        // done() holds. Once it finds nothing for a few rounds it sleeps on wake, whose notifier must publish done
+        // first
+        template<typename Done>
+        void helpUntil(Done&& done, EventCount& wake)
+        {
+            XorShift rng(static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())));
+            uint32_t idleRounds = 0;
+            while(!done())
+            {
+                if(auto h = takeForeign(rng))
+                {
+                    idleRounds = 0;
+                    auto* own = std::exchange(running, this);
+                    h.value().resume();
+                    running = own;
+                    continue;
+                }
+                // expired tasks land in the injection queue, the next round takes one of them
+                if(pollTimers() || ++idleRounds < idleSpinRounds)
+                {
+                    continue;
+                }
+                idleRounds = 0;
+                auto key = wake.prepare_wait();
+                if(done())
+                {
+                    wake.cancel_wait();
+                    return;
+                }
+                wake.commit_wait(key);
+            }
+        }
+
+        void set_last_writer_routing(bool enabled) noexcept
+        {
+            last_writer_routing.store(enabled, std::memory_order_relaxed);
+        }
+
+        // true if the calling thread is a worker of this pool that the affinity is satisfied on
+        bool runsHere(Affinity const& affinity) const noexcept
+        {
+            if(!affinity)
+            {
+                return true;
+            }
+            if(context.pool != this)
+            {
+                return false;
+            }
+            switch(affinity.kind)
+            {
+            case AffinityKind::Worker:
+                return affinity.target % thread_queues.size() == context.index;
+            case AffinityKind::NumaNode:
+                return worker_numa[context.index] == static_cast<int>(affinity.target);
+            default:
+                return true;
+            }
+        }
+
+        // number of workers taking part in scheduling, elastic pools change it with the load
+        std::size_t worker_count() const noexcept
+        {
+            return active_workers.load(std::memory_order_relaxed);
+        }
+
+        // workers the pool was created with, the most it can grow to
+        std::size_t max_worker_count() const noexcept
+        {
+            return thread_queues.size();
+        }
+
+        // retires or wakes workers. Retiring ones stop taking new work, run what is left in their own deque, which
+        // other workers may steal from as well, and then sleep. Elastic pools keep adjusting from the new count
+        void set_worker_count(std::size_t count)
+        {
+            if(count == 0 || count > thread_queues.size())
+            {
+                throw std::invalid_argument("Worker count has to be between 1 and the size of the pool.");
+            }
+            active_workers.store(count, std::memory_order_release);
+            retired_workers.notify_all();
+            // parked workers that just retired move over to retired_workers, so notify_one only reaches active ones
+            idle_workers.notify_all();
+        }
+
+        // policy for dispatches that do not pass their own. Safe to change while tasks run
+        void set_spawn_policy(SpawnPolicy policy)
+        {
+            if(policy == SpawnPolicy::PoolDefault)
+            {
+                throw std::invalid_argument("PoolDefault is only a dispatch hint.");
+            }
+            spawn_policy.store(policy, std::memory_order_relaxed);
+        }
+
+        SpawnPolicy get_spawn_policy() const noexcept
+        {
+            return spawn_policy.load(std::memory_order_relaxed);
+        }
+
+        // true if a ready child should be pushed to the pool instead of being run by the dispatching thread
+        bool pushChild(SpawnPolicy hint) const noexcept
+        {
+            auto policy = hint == SpawnPolicy::PoolDefault ? spawn_policy.load(std::memory_order_relaxed) : hint;
+            switch(policy)
+            {
+            case SpawnPolicy::ChildStealing:
+                return true;
+            case SpawnPolicy::Adaptive:
+                // a shallow deque leaves thieves little to take, expose the children. A deep one has plenty, stay
+                // depth first to bound the deque and the number of live frames. Most of those children run inline,
+                // see inlineChild
+                // on a worker lent by another pool the push would go through the injection queue, stay work first
+                return context.pool == this && context.queue->size() < adaptiveSpawnDepth;
+            default:
+                return false;
+            }
+        }
+
+        // true if a ready child should run inline, like a synchronous dispatch, because thieves have enough to take
+        // already: the own deque is deep, or it holds work while no worker is idle. Only the adaptive policy does it
+        bool inlineChild(SpawnPolicy hint) const noexcept
         {
-            thread_queue_p->emplace(h);
+            auto policy = hint == SpawnPolicy::PoolDefault ? spawn_policy.load(std::memory_order_relaxed) : hint;
+            if(policy != SpawnPolicy::Adaptive || context.pool != this)
+            {
+                return false;
+            }
+            auto depth = context.queue->size();
+            return depth >= adaptiveSpawnDepth || (depth > 0 && idle_workers.num_waiters() == 0);
+        }
+
+        // idle workers of this pool run tasks of other, at most other's borrow quota of them at once. The pools have to
+        // outlive each other's workers, shut both down before destroying either
+        void lend_to(ThreadPool& other)
+        {
+            if(&other == this)
+            {
+                throw std::invalid_argument("A pool cannot lend workers to itself.");
+            }
+            std::lock_guard lock(lend_mutex);
+            auto const count = lend_count.load(std::memory_order_relaxed);
+            if(count == maxLendTargets)
+            {
+                throw std::length_error("Too many pools to lend workers to.");
+            }
+            lend_targets[count].store(&other, std::memory_order_relaxed);
+            lend_count.store(count + 1, std::memory_order_release);
+        }
+
+        // most workers of other pools that may run tasks of this pool at the same time. 0 keeps the pool isolated
+        void set_borrow_quota(uint32_t quota) noexcept
+        {
+            borrow_quota.store(quota, std::memory_order_relaxed);
+        }
+
+        uint32_t get_borrow_quota() const noexcept
+        {
+            return borrow_quota.load(std::memory_order_relaxed);
+        }
+
+        // adds n to a statistics counter of the calling thread. Compiles to nothing without RG_ENABLE_STATS
+        static void recordStat(WorkerCounters::Counter counter, uint64_t n = 1) noexcept
+        {
+            if constexpr(statsEnabled)
+            {
+                if(context.stats)
+                {
+                    context.stats->add(counter, n);
+                }
+            }
         }
 
         // void addReadyTask(std::coroutine_handle<> h)
@@ -126,6 +624,65 @@ namespace rg
             stop_source.request_stop();
         }
 
+        // successful steals summed over all workers, indexed by StealLocality
+        std::array<uint64_t, numStealLocalities> steal_locality() const
+        {
+            std::array<uint64_t, numStealLocalities> total{};
+            for(std::size_t w = 0; w < thread_queues.size(); ++w)
+            {
+                for(std::size_t l = 0; l < numStealLocalities; ++l)
+                {
+                    total[l] += steal_counters[w].count[l].load(std::memory_order_relaxed);
+                }
+            }
+            return total;
+        }
+
+        // seeds and steals of every worker so far. Empty steal lists unless PoolOptions::recordTrace is set
+        SchedulerTrace trace() const
+        {
+            SchedulerTrace snapshot;
+            snapshot.workers.reserve(thread_queues.size());
+            for(std::size_t w = 0; w < thread_queues.size(); ++w)
+            {
+                std::lock_guard lock(traces[w].mtx);
+                snapshot.workers.push_back(traces[w].trace);
+            }
+            return snapshot;
+        }
+
+        // snapshot of the scheduler statistics. Only the steal localities are counted without RG_ENABLE_STATS
+        PoolStats stats() const
+        {
+            PoolStats snapshot;
+            auto const size = thread_queues.size();
+            snapshot.workers.reserve(size);
+            for(std::size_t w = 0; w < size; ++w)
+            {
+                auto& worker = snapshot.workers.emplace_back(worker_counters[w], thread_queues[w]->high_water_mark());
+                for(std::size_t l = 0; l < numStealLocalities; ++l)
+                {
+                    worker.steal_locality[l] = steal_counters[w].count[l].load(std::memory_order_relaxed);
+                }
+            }
+            return snapshot;
+        }
+
+        // zero all statistics, e.g. after a warmup run. Updates racing with the reset may survive it
+        void reset_stats()
+        {
+            auto const size = thread_queues.size();
+            for(std::size_t w = 0; w < size; ++w)
+            {
+                worker_counters[w].reset();
+                thread_queues[w]->reset_high_water_mark();
+                for(auto& counter : steal_counters[w].count)
+                {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
     private:
         // check if thread pool has no more work
         // bool done() const
@@ -135,49 +692,582 @@ namespace rg
         //     return worker_states == 0 && stack.empty() && readyQueue.empty();
         // }
 
-        void pinThreadToCore(int core_index)
+        // fixed seeds make the victim choices of a run reproducible, a replay takes them from the trace
+        void initSeeds(std::size_t size, uint32_t seed)
+        {
+            if(replay_trace && replay_trace->workers.size() != size)
+            {
+                throw std::invalid_argument("The replayed trace was recorded with a different number of workers.");
+            }
+            traces = std::make_unique<TraceSlot[]>(size);
+            std::random_device device;
+            for(std::size_t w = 0; w < size; ++w)
+            {
+                if(replay_trace)
+                {
+                    auto const& recorded = replay_trace->workers[w];
+                    if(std::ranges::any_of(recorded.steals, [size](auto const& steal) { return steal.victim >= size; }))
+                    {
+                        throw std::invalid_argument("The replayed trace names a victim outside of the pool.");
+                    }
+                    traces[w].trace.seed = recorded.seed;
+                }
+                else
+                {
+                    traces[w].trace.seed = seed != 0 ? mixSeed(seed, static_cast<uint32_t>(w)) : device();
+                }
+            }
+        }
+
+        void initAffinity(std::vector<hwloc_obj_t> const& placeObjs, std::size_t inboxCapacity)
+        {
+            inboxes.reserve(placeObjs.size());
+            routed.reserve(placeObjs.size());
+            worker_numa.reserve(placeObjs.size());
+            for(std::size_t w = 0; w < placeObjs.size(); ++w)
+            {
+                inboxes.push_back(std::make_unique<rigtorp::MPMCQueue<InjectedTask>>(inboxCapacity));
+                routed.push_back(std::make_unique<rigtorp::MPMCQueue<InjectedTask>>(lastWriterBacklog));
+                auto node = numaNodeOf(topology, placeObjs[w]);
+                worker_numa.push_back(node);
+                if(node < 0)
+                {
+                    continue;
+                }
+                if(static_cast<std::size_t>(node) >= numa_workers.size())
+                {
+                    numa_workers.resize(static_cast<std::size_t>(node) + 1);
+                }
+                numa_workers[static_cast<std::size_t>(node)].push_back(static_cast<uint16_t>(w));
+            }
+            numa_next = std::make_unique<std::atomic<uint32_t>[]>(numa_workers.size());
+        }
+
+        // worker an affinity picks, nothing if it names a node without workers
+        std::optional<uint16_t> affinityTarget(Affinity const& affinity) noexcept
+        {
+            switch(affinity.kind)
+            {
+            case AffinityKind::Worker:
+                return static_cast<uint16_t>(affinity.target % thread_queues.size());
+            case AffinityKind::NumaNode:
+            {
+                if(affinity.target >= numa_workers.size() || numa_workers[affinity.target].empty())
+                {
+                    return std::nullopt;
+                }
+                auto const& workers = numa_workers[affinity.target];
+                return workers[numa_next[affinity.target].fetch_add(1, std::memory_order_relaxed) % workers.size()];
+            }
+            default:
+                return std::nullopt;
+            }
+        }
+
+        // false if the hint cannot be followed and the task should take the normal path
+        bool routeToInbox(std::coroutine_handle<> h, Priority priority, Affinity const& affinity)
+        {
+            auto target = affinityTarget(affinity);
+            if(!target || *target >= active_workers.load(std::memory_order_acquire)
+               || !inboxes[*target]->try_push(InjectedTask{h, priority}))
+            {
+                return false;
+            }
+            recordStat(&WorkerCounters::tasks_pushed);
+            // the event count cannot wake a particular worker, wake them all unless the target is the caller
+            if(context.pool != this || context.index != *target)
+            {
+                idle_workers.notify_all();
+                // the target may have retired since the check above and parked while the inbox was still empty.
+                // Nobody else drains it, so wake the retired workers too. retiredRound rechecks the inbox
+                retired_workers.notify_all();
+            }
+            return true;
+        }
+
+        // resumes the oldest handle that yielded on this worker
+        bool runYielded(uint16_t index)
+        {
+            auto& handles = yielded[index];
+            if(handles.empty())
+            {
+                return false;
+            }
+            auto h = handles.front();
+            handles.pop_front();
+            recordStat(&WorkerCounters::tasks_resumed);
+            h.resume();
+            return true;
+        }
+
+        // runs one task of the own inbox
+        bool runInbox(uint16_t index)
+        {
+            InjectedTask task;
+            if(!inboxes[index]->try_pop(task))
+            {
+                return false;
+            }
+            recordStat(&WorkerCounters::tasks_resumed);
+            task.handle.resume();
+            return true;
+        }
+
+        // runs one task routed to this worker as the last writer of its resource
+        bool runRouted(uint16_t index)
+        {
+            InjectedTask task;
+            if(!routed[index]->try_pop(task))
+            {
+                return false;
+            }
+            recordStat(&WorkerCounters::tasks_resumed);
+            task.handle.resume();
+            return true;
+        }
+
+        // runs a task routed to another worker, nearest first
+        bool takeRouted(uint16_t index)
         {
-            hwloc_obj_t core = hwloc_get_obj_by_type(topology, HWLOC_OBJ_CORE, core_index);
-            if(!core)
+            for(auto victim : victim_orders[index].victims)
             {
-                throw std::runtime_error("Failed to get core for pinning.");
+                InjectedTask task;
+                if(routed[victim]->try_pop(task))
+                {
+                    recordStat(&WorkerCounters::tasks_resumed);
+                    task.handle.resume();
+                    return true;
+                }
             }
+            return false;
+        }
 
-            hwloc_cpuset_t cpuset = hwloc_bitmap_dup(core->cpuset);
-            hwloc_bitmap_singlify(cpuset); // Restrict to a single core
-            if(hwloc_set_cpubind(topology, cpuset, HWLOC_CPUBIND_THREAD) == -1)
+        void pinThread(uint16_t index)
+        {
+            auto const& place = places[index];
+            // unpinned
+            if(!place)
+            {
+                return;
+            }
+            if(hwloc_set_cpubind(topology, place.get(), HWLOC_CPUBIND_THREAD) == -1)
             {
-                hwloc_bitmap_free(cpuset);
                 throw std::runtime_error("Failed to bind thread to core.");
             }
-            hwloc_bitmap_free(cpuset);
+        }
+
+        // recheck before parking. Every queue has to be looked at, a random steal round may have missed work
+        uint64_t currentTick() const noexcept
+        {
+            return static_cast<uint64_t>((std::chrono::steady_clock::now() - timer_epoch) / timer_tick);
+        }
+
+        bool timersDue() const noexcept
+        {
+            auto const deadline = timer_deadline.load(std::memory_order_acquire);
+            return deadline != TimerWheel::never && currentTick() >= deadline;
+        }
+
+        // moves expired timers to the own deque. Costs a load while no timer is pending, a wheel that another
+        // worker is advancing is left to it
+        bool pollTimers()
+        {
+            if(!timersDue())
+            {
+                return false;
+            }
+            std::unique_lock lock(timer_mutex, std::try_to_lock);
+            if(!lock)
+            {
+                return false;
+            }
+            bool expired = false;
+            timers.advance(
+                currentTick(),
+                [this, &expired](TimerWheel::Timer const& timer)
+                {
+                    addTask(timer.handle, timer.priority);
+                    expired = true;
+                });
+            timer_deadline.store(timers.next_expiry(), std::memory_order_release);
+            return expired;
+        }
+
+        // parks the worker. With timers pending, one parked worker wakes up for the next expiry
+        void park(EventCount::Key key)
+        {
+            auto const deadline = timer_deadline.load(std::memory_order_acquire);
+            if(deadline == TimerWheel::never || timer_sleeper.exchange(true, std::memory_order_acq_rel))
+            {
+                idle_workers.commit_wait(key);
+                return;
+            }
+            auto const left
+                = timer_epoch + static_cast<int64_t>(deadline) * timer_tick - std::chrono::steady_clock::now();
+            idle_workers.commit_wait_for(key, std::max<std::chrono::nanoseconds>(left, std::chrono::nanoseconds(0)));
+            timer_sleeper.store(false, std::memory_order_release);
+        }
+
+        bool hasVisibleWork(uint16_t index) const
+        {
+            return !injection_queue.empty() || !inboxes[index]->empty() || !yielded[index].empty() || timersDue()
+                   || std::ranges::any_of(thread_queues, [](auto const& queue) { return !queue->empty(); })
+                   || std::ranges::any_of(routed, [](auto const& queue) { return !queue->empty(); });
+        }
+
+        // one visit to a victim, the rest of a batch of at most max items lands in the same class of our own deque
+        std::optional<std::coroutine_handle<>> stealFrom(
+            stack_type& victim,
+            uint16_t index,
+            Priority priority,
+            int64_t max = maxStealBatch)
+        {
+            recordStat(&WorkerCounters::steal_attempts);
+            auto const ownSize = statsEnabled ? thread_queues[index]->size() : 0;
+            return recordSteal(victim.steal_batch(*thread_queues[index], max, priority), index, ownSize);
+        }
+
+        // sweep the victims nearest first, starting each locality level at a random victim to spread thieves.
+        // Higher classes are swept first, an aged round starts at the lowest class
+        std::optional<std::coroutine_handle<>> steal(uint16_t index, XorShift& rng, bool aged)
+        {
+            if(replay_trace)
+            {
+                if(auto h = replaySteal(index))
+                {
+                    return h;
+                }
+            }
+            auto const& order = victim_orders[index];
+            uint32_t attempts = 0;
+            while(attempts < stealAttempts)
+            {
+                for(std::size_t p = 0; p < numPriorities; ++p)
+                {
+                    auto const priority = static_cast<Priority>(aged ? numPriorities - 1 - p : p);
+                    for(std::size_t l = 0; l < numStealLocalities; ++l)
+                    {
+                        auto level = order.level(l);
+                        auto const n = static_cast<uint32_t>(level.size());
+                        if(n == 0)
+                        {
+                            continue;
+                        }
+                        uint32_t start = rng() % n;
+                        for(uint32_t k = 0; k < n; ++k, ++attempts)
+                        {
+                            auto victim = level[(start + k) % n];
+                            // steal half of the victim, the rest of the batch lands in our own deque
+                            if(auto h = stealFrom(*thread_queues[victim], index, priority))
+                            {
+                                auto& counter = steal_counters[index].count[l];
+                                counter.store(
+                                    counter.load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+                                traceSteal(index, victim, priority);
+                                replayMissed(index);
+                                // left work behind or took more than we run now, let another sleeper help with it
+                                if(!thread_queues[victim]->empty() || !thread_queues[index]->empty())
+                                {
+                                    idle_workers.notify_one();
+                                    growOnBacklog();
+                                }
+                                return h;
+                            }
+                        }
+                    }
+                }
+                // a single worker has nobody to steal from
+                if(order.victims.empty())
+                {
+                    break;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // moves a batch of injected tasks to the own deque. Returns false if the injection queue was empty
+        bool takeInjected(uint16_t index)
+        {
+            InjectedTask task;
+            std::size_t taken = 0;
+            while(taken < maxInjectBatch && injection_queue.try_pop(task))
+            {
+                thread_queues[index]->emplace(task.handle, task.priority);
+                ++taken;
+            }
+            recordStat(&WorkerCounters::tasks_injected, taken);
+            // more than we run now, let another sleeper steal the rest
+            if(taken > 1)
+            {
+                idle_workers.notify_one();
+            }
+            // the queue may hold more than one batch
+            if(taken == maxInjectBatch)
+            {
+                growOnBacklog();
+            }
+            return taken > 0;
+        }
+
+        // work is piling up and no active worker sleeps that could take it, bring back a retired one
+        void growOnBacklog() noexcept
+        {
+            if(min_workers == 0 || idle_workers.num_waiters() != 0)
+            {
+                return;
+            }
+            auto current = active_workers.load(std::memory_order_relaxed);
+            if(current < thread_queues.size()
+               && active_workers.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel))
+            {
+                retired_workers.notify_all();
+            }
+        }
+
+        // the highest active worker of an elastic pool retires after it kept parking without finding work. Retiring
+        // from the top keeps the active workers a prefix of the victim orders
+        bool tryRetire(uint16_t index) noexcept
+        {
+            std::size_t expected = index + 1u;
+            return min_workers != 0 && expected > min_workers
+                   && active_workers.compare_exchange_strong(expected, index, std::memory_order_acq_rel);
+        }
+
+        // a retired worker runs its own leftovers, then sleeps until the pool grows past its index
+        void retiredRound(uint16_t index, std::stop_token const& stoken)
+        {
+            if(auto h = thread_queues[index]->pop(false))
+            {
+                recordStat(&WorkerCounters::tasks_resumed);
+                h.value().resume();
+                return;
+            }
+            // routed here before the worker retired
+            if(runInbox(index) || runYielded(index))
+            {
+                return;
+            }
+            auto key = retired_workers.prepare_wait();
+            if(stoken.stop_requested() || index < active_workers.load(std::memory_order_acquire)
+               || !thread_queues[index]->empty() || !inboxes[index]->empty() || !yielded[index].empty())
+            {
+                retired_workers.cancel_wait();
+                return;
+            }
+            recordStat(&WorkerCounters::parks);
+            retired_workers.commit_wait(key);
+        }
+
+        // hands a single task to a worker of another pool if the quota allows it. Injected tasks go first, they
+        // have no worker of this pool yet. A returned task holds a borrow slot until returnBorrowed
+        std::optional<std::coroutine_handle<>> lendTask(XorShift& rng)
+        {
+            auto current = borrowed.load(std::memory_order_relaxed);
+            do
+            {
+                if(current >= borrow_quota.load(std::memory_order_relaxed))
+                {
+                    return std::nullopt;
+                }
+            } while(!borrowed.compare_exchange_weak(current, current + 1, std::memory_order_acquire));
+
+            if(auto h = takeForeign(rng))
+            {
+                return h;
+            }
+            returnBorrowed();
+            return std::nullopt;
+        }
+
+        // a single task for a thread that is not a worker of this pool. Injected tasks go first, they have no worker
+        // of this pool yet, then one steal per deque, highest class first
+        std::optional<std::coroutine_handle<>> takeForeign(XorShift& rng)
+        {
+            if(InjectedTask task; injection_queue.try_pop(task))
+            {
+                return task.handle;
+            }
+            auto const n = static_cast<uint32_t>(thread_queues.size());
+            uint32_t start = rng() % n;
+            for(std::size_t p = 0; p < numPriorities; ++p)
+            {
+                for(uint32_t k = 0; k < n; ++k)
+                {
+                    if(auto h = (*thread_queues[(start + k) % n])[static_cast<Priority>(p)].steal())
+                    {
+                        return h;
+                    }
+                }
+            }
+            return std::nullopt;
+        }
+
+        void returnBorrowed() noexcept
+        {
+            borrowed.fetch_sub(1, std::memory_order_release);
+        }
+
+        // runs one task of a pool this one lends its workers to. Returns false if none had work to spare
+        bool runBorrowed(XorShift& rng)
+        {
+            auto const count = lend_count.load(std::memory_order_acquire);
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                auto* other = lend_targets[i].load(std::memory_order_relaxed);
+                if(auto h = other->lendTask(rng))
+                {
+                    recordStat(&WorkerCounters::tasks_borrowed);
+                    running = other;
+                    h.value().resume();
+                    running = this;
+                    other->returnBorrowed();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // the own deque was empty before the steal, everything in it now came with the batch
+        void traceSteal(uint16_t index, uint16_t victim, Priority priority)
+        {
+            if(record_trace)
+            {
+                auto const items = static_cast<uint32_t>(1 + thread_queues[index]->size());
+                std::lock_guard lock(traces[index].mtx);
+                traces[index].trace.steals.push_back({victim, priority, items});
+            }
+        }
+
+        // follows the next recorded steal of this worker, with the recorded batch size. The decision is only used up
+        // once its victim gave work. Until then the worker falls back to its normal sweep after replayPatience tries,
+        // rounds in which nobody has work yet consume nothing, see replayMissed
+        std::optional<std::coroutine_handle<>> replaySteal(uint16_t index)
+        {
+            auto& slot = traces[index];
+            auto const& recorded = replay_trace->workers[index].steals;
+            if(slot.replayCursor == recorded.size())
+            {
+                return std::nullopt;
+            }
+            auto const& decision = recorded[slot.replayCursor];
+            auto const items = std::max<int64_t>(decision.items, 1);
+            for(uint32_t attempt = 0; attempt < replayPatience; ++attempt)
+            {
+                if(auto h = stealFrom(*thread_queues[decision.victim], index, decision.priority, items))
+                {
+                    ++slot.replayCursor;
+                    traceSteal(index, decision.victim, decision.priority);
+                    return h;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // the normal sweep stole while a recorded decision was pending. The schedule diverged, the steal takes the
+        // place of the decision
+        void replayMissed(uint16_t index)
+        {
+            if(!replay_trace)
+            {
+                return;
+            }
+            auto& slot = traces[index];
+            if(slot.replayCursor < replay_trace->workers[index].steals.size())
+            {
+                ++slot.replayCursor;
+                std::lock_guard lock(slot.mtx);
+                ++slot.trace.diverged;
+            }
+        }
+
+        // counts a successful steal, ownSize is the size of the thief's deque before the batch landed in it
+        std::optional<std::coroutine_handle<>> recordSteal(
+            std::optional<std::coroutine_handle<>> h,
+            [[maybe_unused]] uint16_t index,
+            [[maybe_unused]] std::size_t ownSize) const noexcept
+        {
+            if constexpr(statsEnabled)
+            {
+                if(h)
+                {
+                    recordStat(&WorkerCounters::steals);
+                    recordStat(&WorkerCounters::stolen_items, 1 + thread_queues[index]->size() - ownSize);
+                }
+            }
+            return h;
+        }
+
+        // steal and account the time spent in it
+        std::optional<std::coroutine_handle<>> timedSteal(uint16_t index, XorShift& rng, bool aged)
+        {
+            if constexpr(statsEnabled)
+            {
+                auto start = std::chrono::steady_clock::now();
+                auto h = steal(index, rng, aged);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                recordStat(
+                    &WorkerCounters::steal_time_ns,
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                return h;
+            }
+            else
+            {
+                return steal(index, rng, aged);
+            }
         }
 
         void worker([[maybe_unused]] uint16_t index, std::stop_token stoken)
         {
-            thread_queue_p = thread_queues[index].get();
+            context = {this, thread_queues[index].get(), &worker_counters[index], index};
+            running = this;
 
             // mt19937 seems overkill. Heavier, higher quality random number
             // std::minstd_rand and XorShift are alternatives
             // https://github.com/ConorWilliams/Threadpool/blob/main/include/riften/xoroshiro128starstar.hpp
-            thread_local rg::XorShift rng(std::random_device{}());
-            std::uniform_int_distribution<uint32_t> dist(0, thread_queues.size() - 1);
+            rg::XorShift rng(traces[index].trace.seed);
 
             // uint64_t mask = (1ULL << index);
             // while(!done())
             // std::cout << "Thread created " << std::this_thread::get_id() << std::endl;
             // std::coroutine_handle<> h;
             std::optional<std::coroutine_handle<>> h;
+            uint32_t idleRounds = 0;
+            uint32_t idleParks = 0;
+            uint32_t agingRounds = 0;
             while(!stoken.stop_requested())
             {
+                if(index >= active_workers.load(std::memory_order_acquire))
+                {
+                    idleRounds = 0;
+                    idleParks = 0;
+                    retiredRound(index, stoken);
+                    continue;
+                }
+                bool const aged = ++agingRounds % agingPeriod == 0;
+                // bounds the latency of submitted and routed tasks while the own deque never runs dry
+                if(aged)
+                {
+                    pollTimers();
+                    takeInjected(index);
+                    if(runInbox(index) || runRouted(index) || runYielded(index))
+                    {
+                        idleRounds = 0;
+                        idleParks = 0;
+                        continue;
+                    }
+                }
                 // if(thread_queues[index]->try_pop(h))
                 // {
                 //     h.resume();
                 //     continue;
                 // }
-                h = thread_queues[index]->pop();
+                h = thread_queues[index]->pop(aged);
                 if(h)
                 {
+                    idleRounds = 0;
+                    idleParks = 0;
+                    recordStat(&WorkerCounters::tasks_resumed);
                     h.value().resume();
                     continue;
                 }
@@ -193,7 +1283,7 @@ namespace rg
                 // }
                 // increases latency when everyhting is done, as stealing may still be tried for a while after stop has
                 // been requested
-                // for(uint32_t attempts = 0; attempts < randomStealAttempts; ++attempts)
+                // for(uint32_t attempts = 0; attempts < stealAttempts; ++attempts)
                 // {
                 //     size_t victim = dist(rng);
                 //     if(victim != index && thread_queues[victim]->try_pop(h))
@@ -203,36 +1293,77 @@ namespace rg
                 //     }
                 // }
 
-                for(uint32_t attempts = 0; attempts < randomStealAttempts; ++attempts)
+                // tasks routed to this worker go before anything that others could run as well
+                if(runInbox(index) || runRouted(index))
                 {
-                    size_t victim = dist(rng);
-                    if(victim != index)
-                    {
-                        h = thread_queues[victim]->steal();
-                        if(h)
-                        {
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        h = master_queue.steal();
-                        if(h)
-                        {
-                            break;
-                        }
-                    }
-                    // std::this_thread::yield();
+                    idleRounds = 0;
+                    idleParks = 0;
+                    continue;
                 }
 
+                if(takeInjected(index) || pollTimers())
+                {
+                    idleParks = 0;
+                    continue;
+                }
+
+                h = timedSteal(index, rng, aged);
+
                 if(h)
                 {
+                    idleRounds = 0;
+                    idleParks = 0;
+                    recordStat(&WorkerCounters::tasks_resumed);
                     h.value().resume();
                     continue;
                 }
 
-                // check barrier queue resumption
-                barrier_queue.process_and_extract(this);
+                // routed tasks of other workers. The last writer runs its own before it steals, so they are left to us
+                // when it is busy or retired
+                if(takeRouted(index))
+                {
+                    idleRounds = 0;
+                    idleParks = 0;
+                    continue;
+                }
+
+                // the handles that yielded get the worker back once nothing else could run here
+                if(runYielded(index))
+                {
+                    idleRounds = 0;
+                    idleParks = 0;
+                    continue;
+                }
+
+                // nothing to do here, help a pool we lend workers to
+                if(runBorrowed(rng))
+                {
+                    idleRounds = 0;
+                    continue;
+                }
+
+                // spin for a few rounds before parking, as new work often shows up shortly
+                if(++idleRounds < idleSpinRounds)
+                {
+                    continue;
+                }
+                idleRounds = 0;
+
+                auto key = idle_workers.prepare_wait();
+                if(stoken.stop_requested() || hasVisibleWork(index)
+                   || index >= active_workers.load(std::memory_order_acquire))
+                {
+                    idle_workers.cancel_wait();
+                    continue;
+                }
+                // parked again and again without work in between, the pool is larger than the load
+                if(++idleParks >= retire_after_parks && tryRetire(index))
+                {
+                    idle_workers.cancel_wait();
+                    continue;
+                }
+                recordStat(&WorkerCounters::parks);
+                park(key);
                 // seperate this popping order into a function
                 // if(readyQueue.try_pop(h))
                 // {
@@ -290,7 +1421,6 @@ namespace rg
             //              - DO POOL WORK
             //      - current continuation pauses
             //  else execute and DO POOL WORK
-            // HOW TO SLEEP?
         }
 
     public:
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Priority.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <coroutine>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace rg
+{
+    // hierarchical timer wheel over integer ticks. Level L has 64 slots of 64^L ticks each, a timer sits in the
+    // level of the highest base 64 digit in which its expiry differs from the current tick and moves down a level
+    // whenever the current tick reaches the start of its slot. Timers beyond the last level wait in an overflow list
+    // that is sorted in again every 64^levels ticks. Not thread safe, the pool guards it with a mutex
+    class TimerWheel
+    {
+    public:
+        struct Timer
+        {
+            std::coroutine_handle<> handle;
+            Priority priority = Priority::Normal;
+            uint64_t expiry = 0;
+        };
+
+        static constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+
+        // false if the timer is already due, the caller runs it then
+        bool schedule(Timer timer)
+        {
+            if(timer.expiry <= current)
+            {
+                return false;
+            }
+            place(timer);
+            ++count;
+            return true;
+        }
+
+        // moves the wheel to now and calls onExpired for every timer that is due, in the order of expiry ticks
+        template<typename OnExpired>
+        void advance(uint64_t now, OnExpired&& onExpired)
+        {
+            while(current < now)
+            {
+                auto next = next_expiry();
+                if(next > now)
+                {
+                    current = now;
+                    return;
+                }
+                current = next;
+                // higher levels first, their timers may move into the slot of the current tick
+                for(std::size_t level = levels; level-- > 0;)
+                {
+                    if((current & ((uint64_t{1} << (level * slotBits)) - 1)) != 0)
+                    {
+                        continue;
+                    }
+                    auto slot = static_cast<std::size_t>((current >> (level * slotBits)) & slotMask);
+                    if((occupied[level] & (uint64_t{1} << slot)) == 0)
+                    {
+                        continue;
+                    }
+                    occupied[level] &= ~(uint64_t{1} << slot);
+                    scratch.swap(slots[level][slot]);
+                    release(onExpired);
+                }
+                if(!overflow.empty() && (current & (span(levels) - 1)) == 0)
+                {
+                    scratch.swap(overflow);
+                    release(onExpired);
+                }
+            }
+        }
+
+        // first tick at which advance has something to do, never if the wheel is empty. A timer that waits in a
+        // higher level counts with the start of its slot, so this can be earlier than the earliest expiry
+        uint64_t next_expiry() const noexcept
+        {
+            if(count == 0)
+            {
+                return never;
+            }
+            auto next = never;
+            for(std::size_t level = 0; level < levels; ++level)
+            {
+                if(occupied[level] != 0)
+                {
+                    auto slot = static_cast<uint64_t>(std::countr_zero(occupied[level]));
+                    auto window = current & ~(span(level + 1) - 1);
+                    next = std::min(next, window | (slot << (level * slotBits)));
+                }
+            }
+            if(!overflow.empty())
+            {
+                next = std::min(next, (current & ~(span(levels) - 1)) + span(levels));
+            }
+            return next;
+        }
+
+        uint64_t now() const noexcept
+        {
+            return current;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return count;
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+    private:
+        static constexpr std::size_t slotBits = 6;
+        static constexpr std::size_t slotCount = std::size_t{1} << slotBits;
+        static constexpr uint64_t slotMask = slotCount - 1;
+        static constexpr std::size_t levels = 4;
+
+        // ticks covered by one slot of the level above
+        static constexpr uint64_t span(std::size_t level) noexcept
+        {
+            return uint64_t{1} << (level * slotBits);
+        }
+
+        void place(Timer const& timer)
+        {
+            auto const level = static_cast<std::size_t>(std::bit_width(timer.expiry ^ current) - 1) / slotBits;
+            if(level >= levels)
+            {
+                overflow.push_back(timer);
+                return;
+            }
+            auto slot = static_cast<std::size_t>((timer.expiry >> (level * slotBits)) & slotMask);
+            slots[level][slot].push_back(timer);
+            occupied[level] |= uint64_t{1} << slot;
+        }
+
+        // sorts the timers of a slot in again, relative to the new current tick
+        template<typename OnExpired>
+        void release(OnExpired& onExpired)
+        {
+            for(auto const& timer : scratch)
+            {
+                if(timer.expiry <= current)
+                {
+                    --count;
+                    onExpired(timer);
+                }
+                else
+                {
+                    place(timer);
+                }
+            }
+            scratch.clear();
+        }
+
+        uint64_t current = 0;
+        std::size_t count = 0;
+        std::array<uint64_t, levels> occupied{};
+        std::array<std::array<std::vector<Timer>, slotCount>, levels> slots;
+        std::vector<Timer> overflow;
+        // reused by advance, so slots keep their capacity and expiring allocates nothing
+        std::vector<Timer> scratch;
+    };
+} // namespace rg
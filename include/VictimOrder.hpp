@@ -0,0 +1,89 @@
+#pragma once
+
+#include <hwloc.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rg
+{
+    // distance between a thief and its victim in the hwloc tree, nearest first
+    enum class StealLocality : uint8_t
+    {
+        Core, // same core, i.e. SMT siblings
+        Cache, // shared L2/L3
+        Numa, // same NUMA node
+        Remote, // other NUMA node or socket
+    };
+
+    inline constexpr std::size_t numStealLocalities = 4;
+
+    inline StealLocality classifyLocality(hwloc_topology_t topology, hwloc_obj_t a, hwloc_obj_t b)
+    {
+        if(a == b)
+        {
+            return StealLocality::Core;
+        }
+        hwloc_obj_t ancestor = hwloc_get_common_ancestor_obj(topology, a, b);
+        if(ancestor->type == HWLOC_OBJ_CORE || ancestor->type == HWLOC_OBJ_PU)
+        {
+            return StealLocality::Core;
+        }
+        if(hwloc_obj_type_is_cache(ancestor->type))
+        {
+            return StealLocality::Cache;
+        }
+        // NUMA nodes are memory children in hwloc 2, compare the local nodesets instead of walking the tree
+        if(a->nodeset && b->nodeset && hwloc_bitmap_intersects(a->nodeset, b->nodeset))
+        {
+            return StealLocality::Numa;
+        }
+        return StealLocality::Remote;
+    }
+
+    // victims of one worker, grouped by locality
+    struct VictimOrder
+    {
+        std::vector<uint16_t> victims;
+        // victims of locality l are in [levelBegin[l], levelBegin[l + 1])
+        std::array<uint32_t, numStealLocalities + 1> levelBegin{};
+
+        std::span<uint16_t const> level(std::size_t locality) const
+        {
+            return std::span<uint16_t const>(victims).subspan(
+                levelBegin[locality],
+                levelBegin[locality + 1] - levelBegin[locality]);
+        }
+    };
+
+    // places[i] is the hwloc object worker i runs on
+    inline std::vector<VictimOrder> buildVictimOrders(hwloc_topology_t topology, std::vector<hwloc_obj_t> const& places)
+    {
+        std::vector<VictimOrder> orders(places.size());
+        for(std::size_t thief = 0; thief < places.size(); ++thief)
+        {
+            std::array<std::vector<uint16_t>, numStealLocalities> levels;
+            for(std::size_t victim = 0; victim < places.size(); ++victim)
+            {
+                if(victim != thief)
+                {
+                    auto locality = classifyLocality(topology, places[thief], places[victim]);
+                    levels[static_cast<std::size_t>(locality)].push_back(static_cast<uint16_t>(victim));
+                }
+            }
+
+            auto& order = orders[thief];
+            order.victims.reserve(places.size());
+            for(std::size_t l = 0; l < numStealLocalities; ++l)
+            {
+                order.levelBegin[l] = static_cast<uint32_t>(order.victims.size());
+                order.victims.insert(order.victims.end(), levels[l].begin(), levels[l].end());
+            }
+            order.levelBegin[numStealLocalities] = static_cast<uint32_t>(order.victims.size());
+        }
+        return orders;
+    }
+} // namespace rg
@@ -38,6 +38,17 @@ namespace rg
             return memBlk;
         }
 
+        // count chunks of the block as deallocated, frees the block once all of them are
+        static void releaseChunks(BlockMetaData* metaData, size_t count)
+        {
+            // since only one thread can possibly see this as true, it maybe possible to relax memory order
+            if(metaData->dealloc_count.fetch_add(count, std::memory_order_acq_rel) == Capacity - count)
+            {
+                void* rawPtr = reinterpret_cast<std::byte*>(metaData) + BlockAllocator::prefixSize;
+                BlockAllocator::deallocate({rawPtr, blockSize});
+            }
+        }
+
         // meant to be used with a singleton to ensure thread safe construction and destruction
         struct CurrentBlock
         {
@@ -50,23 +61,24 @@ namespace rg
 
             // Current active block
             void* userPtr{nullptr};
+            BlockMetaData* metaData{nullptr};
             // Unused index in the current block
             uint32_t unusedIdx{0};
 
             ~CurrentBlock()
             {
-                // this destructor should be called before BlockAllocator is destroyed. Tough? Need to control the
-                // order of destruction
+                // chunks handed out from this block may still be alive, count the unused ones as deallocated so the
+                // last live chunk frees the block
                 if(userPtr)
                 {
-                    void* rawPtr = static_cast<std::byte*>(userPtr) - chunkHeaderSize - unusedIdx * chunkSize;
-                    BlockAllocator::deallocate({rawPtr, blockSize});
+                    releaseChunks(metaData, Capacity - unusedIdx);
                 }
             }
 
             void allocateAndSetActiveBlock()
             {
                 MemBlk newBlock = allocateNewBlock();
+                metaData = &BlockAllocator::template getPrefix<detail::BlockId::Inner>(newBlock);
                 // Set to the start of the user memory
                 userPtr = static_cast<std::byte*>(newBlock.ptr) + chunkHeaderSize;
             }
@@ -83,6 +95,8 @@ namespace rg
                 currentBlock.allocateAndSetActiveBlock();
             }
             void* ptr = currentBlock.userPtr;
+            // the chunk header points back to the block, so any thread can deallocate the chunk
+            *reinterpret_cast<BlockMetaData**>(static_cast<std::byte*>(ptr) - chunkHeaderSize) = currentBlock.metaData;
             ++currentBlock.unusedIdx;
             if(currentBlock.unusedIdx == Capacity)
             {
@@ -99,15 +113,8 @@ namespace rg
 
         static void deallocate(MemBlk blk)
         {
-            auto* headerPtr = reinterpret_cast<BlockMetaData*>(static_cast<std::byte*>(blk.ptr) - chunkHeaderSize);
-
-            // increment dealloc_count, if it hits capacity, call deallocate on the block
-            // since only one thread can possibly see this as true, it maybe possible to relax memory order
-            if(headerPtr->dealloc_count.fetch_add(1, std::memory_order_acq_rel) == Capacity - 1)
-            {
-                void* rawPtr = reinterpret_cast<std::byte*>(headerPtr) + BlockAllocator::prefixSize;
-                BlockAllocator::deallocate({rawPtr, blockSize});
-            }
+            auto* metaData = *reinterpret_cast<BlockMetaData**>(static_cast<std::byte*>(blk.ptr) - chunkHeaderSize);
+            releaseChunks(metaData, 1);
         }
     };
 } // namespace rg
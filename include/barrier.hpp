@@ -35,7 +35,11 @@ namespace rg
             resourceNodes.push_back(userQueue);
             handle.coro.template promise<typename std::decay_t<decltype(handle)>::promise_type>()
                 .waitCounter.fetch_add(1, std::memory_order_relaxed);
-            userQueue->add_task({handle.coro.get_coroutine_handle(), AccessMode::Write, &waitCounter});
+            userQueue->add_task(
+                {handle.coro.get_coroutine_handle(),
+                 AccessMode::Write,
+                 &waitCounter,
+                 handle.coro.template promise<typename std::decay_t<decltype(handle)>::promise_type>().priority});
         }
 
         // Process a container of resources
@@ -48,11 +52,15 @@ namespace rg
             }
         }
 
+        // runs once the resources are ready, then waits for the children of the continuation
         template<typename TPromise>
         auto barrierTask(std::coroutine_handle<TPromise> continuation) -> rg::Task<void>
         {
             auto& promise = continuation.promise();
-            promise.pool_p->barrier_queue.emplace_back(promise.self, promise.coroOutsideTask);
+            if(!promise.taskWait.wait(continuation, promise.pool(), promise.priority))
+            {
+                promise.pool()->addTask(continuation, promise.priority);
+            }
             co_return;
         }
 
@@ -68,16 +76,30 @@ namespace rg
         {
             // std::cout << "in barrier" << std::endl;
 
+            // only children to wait for. The last child to complete reschedules h
+            if constexpr(sizeof...(ResArgs) == 0)
+            {
+                if(h.promise().taskWait.wait(h, h.promise().pool(), h.promise().priority))
+                {
+                    return std::noop_coroutine();
+                }
+                return h;
+            }
+
             auto handle = barrierTask(h);
 
             // can access coro because it this function is a friend
             auto& handlePromise = handle.coro.template promise<typename decltype(handle)::promise_type>();
+            // not dispatched through await_transform, pass in the pool ptr here
+            handlePromise.set_pool(h.promise().pool());
+            // the barrier runs in the class of the task waiting on it
+            handlePromise.priority = h.promise().priority;
 
             // continuatiom handled by adding to barrier queue
             // handlePromise.continuationHandle = h;
             // handlePromise.workingState = 2;
 
-            auto& resourceNodes = handlePromise.resourceNodes;
+            auto& resourceNodes = handlePromise.resources().nodes;
             auto& waitCounter = handlePromise.waitCounter;
             resourceNodes.reserve(sizeof...(ResArgs));
 
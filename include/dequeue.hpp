@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <concepts>
@@ -53,10 +55,11 @@ namespace riften
                 return _buff[i & _mask];
             }
 
-            // Allocates and returns a new ring buffer, copies elements in range [b, t) into the new buffer.
-            RingBuff<T>* resize(std::int64_t b, std::int64_t t) const
+            // Allocates and returns a new ring buffer of capacity cap, copies elements in range [t, b) into the new
+            // buffer.
+            RingBuff<T>* resize(std::int64_t b, std::int64_t t, std::int64_t cap) const
             {
-                RingBuff<T>* ptr = new RingBuff{2 * _cap};
+                RingBuff<T>* ptr = new RingBuff{cap};
                 for(std::int64_t i = t; i != b; ++i)
                 {
                     ptr->store(i, load(i));
@@ -84,11 +87,16 @@ namespace riften
     // operations where the deque behaves like a stack. Others can (only) steal data from the deque, they see
     // a FIFO queue. All threads must have finished using the deque before it is destructed. T must be
     // default initializable, trivially destructible and have nothrow move constructor/assignment operators.
+    //
+    // The buffer doubles when full and halves when less than a quarter is used, never below the initial capacity.
+    // Replaced buffers are retired, thieves may still read from them. Thieves announce themselves in a counter and
+    // the owner frees the retired buffers in emplace once it sees no thief in flight.
     template<Simple T>
     class Deque
     {
     public:
-        // Constructs the deque with a given capacity the capacity of the deque (must be power of 2)
+        // Constructs the deque with a given capacity the capacity of the deque (must be power of 2). The buffer
+        // is allocated up front and never shrinks below it.
         explicit Deque(std::int64_t cap = 1024);
 
         // Move/Copy is not supported
@@ -111,13 +119,31 @@ namespace riften
         void emplace(Args&&... args);
 
         // Pops out an item from the deque. Only the owner thread can pop out an item from the deque.
-        // The return can be a std::nullopt if this operation fails (empty deque).
+        // The return can be a std::nullopt if this operation fails (empty deque). While a thief is in flight, the
+        // owner fences it off with a CAS on top, see steal_batch. The oldest item then moves to the bottom.
         std::optional<T> pop() noexcept;
 
         // Steals an item from the deque Any threads can try to steal an item from the deque. The return
         // can be a std::nullopt if this operation failed (not necessarily empty).
         std::optional<T> steal() noexcept;
 
+        // Steals up to half of the items (at most max and batch_capacity) with a single CAS on top. The first item is
+        // returned, the others are pushed to dest, which must be owned by the calling thread. The return can be a
+        // std::nullopt like for steal.
+        //
+        // The range is sized with a bottom that may be stale by the time of the CAS. The owner only pops without a
+        // CAS if it sees no thief announced after storing its new bottom, any thief announced later reads that
+        // bottom. Otherwise the owner moves top itself, which fails the CAS of every thief that read the old top.
+        std::optional<T> steal_batch(Deque& dest, std::int64_t max);
+
+        // Most items steal_batch takes in one visit
+        static constexpr std::int64_t batch_capacity = 64;
+
+        // Most items the deque held at once since construction or the last reset. Only tracked with
+        // RG_ENABLE_STATS, 0 otherwise. Any thread can query and reset.
+        std::size_t high_water_mark() const noexcept;
+        void reset_high_water_mark() noexcept;
+
         // Destruct the deque, all threads must have finished using the deque.
         ~Deque() noexcept;
 
@@ -125,8 +151,40 @@ namespace riften
         alignas(hardware_destructive_interference_size) std::atomic<std::int64_t> _top;
         alignas(hardware_destructive_interference_size) std::atomic<std::int64_t> _bottom;
         alignas(hardware_destructive_interference_size) std::atomic<detail::RingBuff<T>*> _buffer;
+        // Thieves between announcing themselves and their last read of the buffer.
+        alignas(hardware_destructive_interference_size) std::atomic<std::uint32_t> _stealers{0};
+
+        std::int64_t _min_cap; // Initial capacity, the buffer does not shrink below it.
+        std::vector<std::unique_ptr<detail::RingBuff<T>>> _garbage; // Retired buffers, freed by reclaim.
+
+        // Replace the buffer by one of capacity cap, only called by the owner.
+        detail::RingBuff<T>* replace_buffer(detail::RingBuff<T>* buf, std::int64_t b, std::int64_t t, std::int64_t cap);
+
+        // Free the retired buffers if no thief can still hold a pointer to them, only called by the owner.
+        void reclaim() noexcept;
+
+        // Announces a thief for its lifetime. Reclaim keeps the buffers and pop fences thieves off while one is set.
+        struct Announce
+        {
+            std::atomic<std::uint32_t>& stealers;
+
+            explicit Announce(std::atomic<std::uint32_t>& counter) noexcept : stealers{counter}
+            {
+                stealers.fetch_add(1, relaxed);
+            }
+
+            Announce(Announce const&) = delete;
+            Announce& operator=(Announce const&) = delete;
+
+            ~Announce()
+            {
+                stealers.fetch_sub(1, release);
+            }
+        };
 
-        std::vector<std::unique_ptr<detail::RingBuff<T>>> _garbage; // Store old buffers here.
+#ifdef RG_ENABLE_STATS
+        std::atomic<std::int64_t> _high_water{0}; // Only written by the owner in emplace, and by resets.
+#endif
 
         // Convenience aliases.
         static constexpr std::memory_order relaxed = std::memory_order_relaxed;
@@ -140,6 +198,7 @@ namespace riften
     Deque<T>::Deque(std::int64_t cap) : _top(0)
                                       , _bottom(0)
                                       , _buffer(new detail::RingBuff<T>{cap})
+                                      , _min_cap(cap)
     {
         _garbage.reserve(32);
     }
@@ -171,6 +230,11 @@ namespace riften
         // Construct before acquiring slot in-case constructor throws
         T object(std::forward<Args>(args)...);
 
+        if(!_garbage.empty())
+        {
+            reclaim();
+        }
+
         std::int64_t b = _bottom.load(relaxed);
         std::int64_t t = _top.load(acquire);
         detail::RingBuff<T>* buf = _buffer.load(relaxed);
@@ -178,8 +242,12 @@ namespace riften
         if(buf->capacity() < (b - t) + 1)
         {
             // Queue is full, build a new one
-            _garbage.emplace_back(std::exchange(buf, buf->resize(b, t)));
-            _buffer.store(buf, relaxed);
+            buf = replace_buffer(buf, b, t, 2 * buf->capacity());
+        }
+        else if(buf->capacity() > _min_cap && 4 * ((b - t) + 1) < buf->capacity())
+        {
+            // The burst is over, give back half. Thieves only move t forward, so [t, b) covers every live item
+            buf = replace_buffer(buf, b, t, buf->capacity() / 2);
         }
 
         // Construct new object, this does not have to be atomic as no one can steal this item until after we
@@ -188,6 +256,13 @@ namespace riften
 
         std::atomic_thread_fence(release);
         _bottom.store(b + 1, relaxed);
+
+#ifdef RG_ENABLE_STATS
+        if(b + 1 - t > _high_water.load(relaxed))
+        {
+            _high_water.store(b + 1 - t, relaxed);
+        }
+#endif
     }
 
     template<Simple T>
@@ -199,8 +274,26 @@ namespace riften
         _bottom.store(b, relaxed); // Stealers can no longer steal
 
         std::atomic_thread_fence(seq_cst);
+        // Pairs with the fence in steal_batch. A thief not announced here reads the bottom stored above. An announced
+        // one may have sized its range with the old bottom, so b is only ours once top moved past its read
+        bool const thieves = _stealers.load(acquire) != 0;
         std::int64_t t = _top.load(relaxed);
 
+        while(t < b && thieves)
+        {
+            // Take the oldest item too, every thief that read the old top fails its CAS
+            if(_top.compare_exchange_strong(t, t + 1, seq_cst, relaxed))
+            {
+                // Both slots are ours. The oldest item goes back at the bottom, the popped one stays the newest
+                T x = buf->load(b);
+                buf->store(b, buf->load(t));
+                std::atomic_thread_fence(release);
+                _bottom.store(b + 1, relaxed);
+                return x;
+            }
+            // A thief moved top first, t is the new top. A range sized with the old bottom ends at b + 1 at most
+        }
+
         if(t <= b)
         {
             // Non-empty deque
@@ -227,9 +320,36 @@ namespace riften
         }
     }
 
+    template<Simple T>
+    detail::RingBuff<T>* Deque<T>::replace_buffer(
+        detail::RingBuff<T>* buf,
+        std::int64_t b,
+        std::int64_t t,
+        std::int64_t cap)
+    {
+        _garbage.emplace_back(std::exchange(buf, buf->resize(b, t, cap)));
+        _buffer.store(buf, relaxed);
+        return buf;
+    }
+
+    template<Simple T>
+    void Deque<T>::reclaim() noexcept
+    {
+        // Pairs with the fence in steal. A thief whose announcement we do not see has not loaded the buffer yet and
+        // will load the current one
+        std::atomic_thread_fence(seq_cst);
+        if(_stealers.load(acquire) == 0)
+        {
+            _garbage.clear();
+        }
+    }
+
     template<Simple T>
     std::optional<T> Deque<T>::steal() noexcept
     {
+        // Announce the read of the buffer, reclaim frees retired buffers only while no thief is in flight
+        Announce announce{_stealers};
+
         std::int64_t t = _top.load(acquire);
         std::atomic_thread_fence(seq_cst);
         std::int64_t b = _bottom.load(acquire);
@@ -258,6 +378,63 @@ namespace riften
         }
     }
 
+    template<Simple T>
+    std::optional<T> Deque<T>::steal_batch(Deque& dest, std::int64_t max)
+    {
+        // Announced before the read of bottom, see pop
+        Announce announce{_stealers};
+
+        std::int64_t t = _top.load(acquire);
+        std::atomic_thread_fence(seq_cst);
+        std::int64_t b = _bottom.load(acquire);
+
+        // half rounded up, so a single item can still be stolen
+        std::int64_t const n = std::min({(b - t + 1) / 2, max, batch_capacity});
+        if(n <= 0)
+        {
+            // Empty deque.
+            return std::nullopt;
+        }
+
+        // Read the range before claiming it, like steal. Items of a lost race may be corrupt, they are dropped
+        std::array<T, batch_capacity> items;
+        detail::RingBuff<T>* buf = _buffer.load(consume);
+        for(std::int64_t i = 0; i < n; ++i)
+        {
+            items[static_cast<std::size_t>(i)] = buf->load(t + i);
+        }
+
+        if(!_top.compare_exchange_strong(t, t + n, seq_cst, relaxed))
+        {
+            // Failed race.
+            return std::nullopt;
+        }
+
+        for(std::int64_t i = 1; i < n; ++i)
+        {
+            dest.emplace(std::move(items[static_cast<std::size_t>(i)]));
+        }
+        return items[0];
+    }
+
+    template<Simple T>
+    std::size_t Deque<T>::high_water_mark() const noexcept
+    {
+#ifdef RG_ENABLE_STATS
+        return static_cast<std::size_t>(_high_water.load(relaxed));
+#else
+        return 0;
+#endif
+    }
+
+    template<Simple T>
+    void Deque<T>::reset_high_water_mark() noexcept
+    {
+#ifdef RG_ENABLE_STATS
+        _high_water.store(0, relaxed);
+#endif
+    }
+
     template<Simple T>
     Deque<T>::~Deque() noexcept
     {
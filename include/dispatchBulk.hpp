@@ -0,0 +1,314 @@
+#pragma once
+
+#include "Affinity.hpp"
+#include "ResourceNode.hpp"
+#include "Task.hpp"
+#include "TaskHints.hpp"
+#include "TaskWait.hpp"
+#include "ThreadPool.hpp"
+#include "dispatchTask.hpp"
+#include "waitCounter.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rg
+{
+    namespace detail
+    {
+        // join counter of a task group. It hangs between the dispatching task and the children of the group, so
+        // barriers of the dispatching task still wait for every child. The group handle and the completion of the
+        // subtree share ownership, whichever comes last frees it
+        struct GroupJoin : TaskWait
+        {
+            std::atomic<uint32_t> owners{2};
+
+            GroupJoin() noexcept
+            {
+                completed = [](TaskWait& wait) { static_cast<GroupJoin&>(wait).drop(); };
+            }
+
+            void drop() noexcept
+            {
+                if(owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    delete this;
+                }
+            }
+
+            // the awaiting task takes the slot of a body until it calls release after the wait. Returns false,
+            // without taking the slot, if the subtree is complete already
+            bool wait(std::coroutine_handle<> h, ThreadPool* pool_p, Priority priority) noexcept
+            {
+                waiter = h;
+                waiterPool = pool_p;
+                waiterPriority = priority;
+                if(pending.fetch_add(waitingFlag + 1, std::memory_order_acq_rel) == 0)
+                {
+                    pending.fetch_sub(waitingFlag + 1, std::memory_order_relaxed);
+                    return false;
+                }
+                return true;
+            }
+        };
+
+        // co_await of a task group
+        struct GroupAwaiter
+        {
+            GroupJoin* join;
+            bool waited = false;
+
+            bool await_ready() const noexcept
+            {
+                return join->pending.load(std::memory_order_acquire) == 0;
+            }
+
+            template<typename TPromise>
+            bool await_suspend(std::coroutine_handle<TPromise> h) noexcept
+            {
+                // set before the wait, once it suspends the task may already run elsewhere
+                waited = true;
+                if(!join->wait(h, h.promise().pool(), h.promise().priority))
+                {
+                    waited = false;
+                    return false;
+                }
+                return true;
+            }
+
+            void await_resume() const noexcept
+            {
+                if(waited)
+                {
+                    join->release();
+                }
+            }
+        };
+    } // namespace detail
+
+    // children of one dispatch_bulk. Index it to get at single tasks, or co_await it to wait for all of them. A
+    // group that is dropped early leaves its children running.
+    // A child frees its resources when its frame goes away, so like a held Task, a held child keeps the next access
+    // to its resources waiting. Groups of Task<void> have no results to hand out and drop their children right away,
+    // children returning a SlotTask only hold their result slots
+    template<typename TaskT>
+    struct TaskGroup
+    {
+        static constexpr bool keepsTasks = !std::is_void_v<typename TaskT::promise_type::return_type>;
+
+        TaskGroup(std::vector<TaskT> children, detail::GroupJoin* groupJoin) noexcept
+            : count{children.size()}
+            , join{groupJoin}
+        {
+            if constexpr(keepsTasks)
+            {
+                tasks = std::move(children);
+            }
+        }
+
+        TaskGroup(TaskGroup const&) = delete;
+        TaskGroup& operator=(TaskGroup const&) = delete;
+
+        TaskGroup(TaskGroup&& other) noexcept
+            : tasks{std::move(other.tasks)}
+            , count{std::exchange(other.count, 0)}
+            , join{std::exchange(other.join, nullptr)}
+        {
+        }
+
+        TaskGroup& operator=(TaskGroup&& other) noexcept
+        {
+            if(this != &other)
+            {
+                if(join)
+                {
+                    join->drop();
+                }
+                tasks = std::move(other.tasks);
+                count = std::exchange(other.count, 0);
+                join = std::exchange(other.join, nullptr);
+            }
+            return *this;
+        }
+
+        ~TaskGroup()
+        {
+            if(join)
+            {
+                join->drop();
+            }
+        }
+
+        std::size_t size() const noexcept
+        {
+            return count;
+        }
+
+        TaskT& operator[](std::size_t i) noexcept
+            requires keepsTasks
+        {
+            return tasks[i];
+        }
+
+        auto begin() noexcept
+            requires keepsTasks
+        {
+            return tasks.begin();
+        }
+
+        auto end() noexcept
+            requires keepsTasks
+        {
+            return tasks.end();
+        }
+
+        // resumes once every child and all of their children are done
+        auto operator co_await() noexcept
+        {
+            return detail::GroupAwaiter{join};
+        }
+
+    private:
+        std::vector<TaskT> tasks;
+        std::size_t count;
+        detail::GroupJoin* join;
+    };
+
+    // created by dispatch_bulk. Hooks the children up with the awaiting task and publishes the ready ones in one
+    // batch, the awaiting task carries on without suspending
+    template<typename TaskT>
+    struct BulkDispatchAwaiter
+    {
+        using promise_type = typename TaskT::promise_type;
+
+        std::vector<TaskT> tasks;
+        Priority priority;
+        Affinity affinity;
+
+        BulkDispatchAwaiter(Priority childPriority, Affinity childAffinity) noexcept
+            : priority{childPriority}
+            , affinity{childAffinity}
+        {
+        }
+
+        // sets a child up like dispatch_task does, except that it stays blocked until await_suspend
+        template<typename... Args>
+        void add(TaskT&& task, uint16_t resourceCount, Args const&... args)
+        {
+            auto& promise = task.coro.template promise<promise_type>();
+            promise.priority = priority;
+            promise.affinity = affinity;
+            if constexpr(promise_type::takesResources)
+            {
+                if(resourceCount > 0)
+                {
+                    promise.resources().nodes.reserve(resourceCount);
+                }
+                promise.waitCounter.fetch_add(resourceCount, std::memory_order_relaxed);
+                (registerAccess(task.coro.get_coroutine_handle(), promise, args), ...);
+            }
+            else
+            {
+                static_assert(
+                    (!HasAccessType<std::decay_t<Args>> && ...),
+                    "a LightTask takes no resources, return an rg::Task instead");
+            }
+            tasks.push_back(std::move(task));
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename TPromise>
+        bool await_suspend(std::coroutine_handle<TPromise> h)
+        {
+            auto& parentPromise = h.promise();
+            auto* pool_p = parentPromise.pool();
+            join = new detail::GroupJoin;
+            parentPromise.taskWait.add_child(*join);
+
+            std::vector<std::coroutine_handle<>> ready;
+            ready.reserve(tasks.size());
+            for(auto& task : tasks)
+            {
+                auto& promise = task.coro.template promise<promise_type>();
+                promise.set_pool(pool_p);
+                promise.parent = parentPromise.self;
+                join->add_child(promise.taskWait);
+                // the child could not be readied before this, so it sees its pool and parent
+                bool childReady = true;
+                if constexpr(promise_type::takesResources)
+                {
+                    childReady = publishTask(promise);
+                }
+                if(childReady)
+                {
+                    ready.push_back(task.coro.get_coroutine_handle());
+                }
+            }
+            // the slot of the body, the children keep the join open from here on
+            join->release();
+
+            if(affinity)
+            {
+                for(auto child : ready)
+                {
+                    pool_p->addTask(child, priority, affinity);
+                }
+            }
+            else if(!ready.empty())
+            {
+                pool_p->addTasks(ready, priority);
+            }
+            return false;
+        }
+
+        TaskGroup<TaskT> await_resume() noexcept
+        {
+            for(auto& task : tasks)
+            {
+                task.drop_frame();
+            }
+            return TaskGroup<TaskT>{std::move(tasks), join};
+        }
+
+    private:
+        detail::GroupJoin* join{};
+    };
+
+    // co_await rg::dispatch_bulk(hints, n, callable, args...) creates the n children callable(i, args...) for i in
+    // [0, n), registers their resource accesses and publishes them to the pool in one batch. Every child gets the
+    // same arguments besides the index, so accesses to one resource serialize unless they are reads
+    template<typename Callable, typename... Args>
+    auto dispatch_bulk(TaskHints hints, std::size_t n, Callable&& callable, Args&&... args)
+    {
+        uint16_t probe = 0;
+        using TaskT = decltype(std::invoke(callable, std::size_t{}, process_handle(args, probe)...));
+
+        BulkDispatchAwaiter<TaskT> awaiter{hints.priority, resolveAffinity(hints.affinity)};
+        awaiter.tasks.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            uint16_t resourceCount = 0;
+            auto task = std::invoke(callable, i, process_handle(args, resourceCount)...);
+            awaiter.add(std::move(task), resourceCount, args...);
+        }
+        return awaiter;
+    }
+
+    // bulk dispatch in the normal priority class
+    template<typename Callable, typename... Args>
+    requires(!std::is_same_v<std::decay_t<Callable>, TaskHints>)
+    auto dispatch_bulk(std::size_t n, Callable&& callable, Args&&... args)
+    {
+        return dispatch_bulk(TaskHints{}, n, std::forward<Callable>(callable), std::forward<Args>(args)...);
+    }
+} // namespace rg
@@ -0,0 +1,263 @@
+#pragma once
+
+#include "Affinity.hpp"
+#include "CoroAllocator.hpp"
+#include "Priority.hpp"
+#include "ResourceNode.hpp"
+#include "SharedCoroutineHandle.hpp"
+#include "TaskHints.hpp"
+#include "TaskWait.hpp"
+#include "ThreadPool.hpp"
+#include "dispatchTask.hpp"
+#include "resources.hpp"
+#include "waitCounter.hpp"
+
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace rg
+{
+    namespace detail
+    {
+        // resource nodes of a call, sized at compile time. Offers what registerAccess and recordLastWriter use
+        template<std::size_t N>
+        struct CallNodes
+        {
+            std::array<std::shared_ptr<ResourceNode>, N> nodes;
+            std::size_t count = 0;
+
+            void push_back(std::shared_ptr<ResourceNode> const& node)
+            {
+                nodes[count++] = node;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return count;
+            }
+
+            operator std::span<std::shared_ptr<ResourceNode> const>() const noexcept
+            {
+                return {nodes.data(), count};
+            }
+        };
+
+        // the ResourceList of a call
+        template<std::size_t N>
+        struct CallResources
+        {
+            CallNodes<N> nodes;
+            // see writeBit
+            uint64_t writeMask = 0;
+        };
+
+        // what a call keeps of an argument: the data behind a resource access by reference, anything else by value
+        template<typename Arg, bool = HasAccessType<std::decay_t<Arg>>>
+        struct CallArg
+        {
+            using type = std::decay_t<Arg>;
+        };
+
+        template<typename Arg>
+        struct CallArg<Arg, true>
+        {
+            using type = decltype(std::declval<std::decay_t<Arg>&>().get());
+        };
+
+        template<typename... Args>
+        inline constexpr std::size_t resourceCount = (std::size_t{0} + ... + HasAccessType<std::decay_t<Args>>);
+
+        template<std::size_t N>
+        struct CallPromise;
+
+        // returned by callFrame, the handle of the suspended call
+        template<std::size_t N>
+        struct CallFrame
+        {
+            using promise_type = CallPromise<N>;
+
+            std::coroutine_handle<CallPromise<N>> handle;
+        };
+
+        // final suspend of a call. Hands the resources on, frees the frame and then releases the parent
+        struct FinishCall
+        {
+            constexpr bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            template<std::size_t N>
+            void await_suspend(std::coroutine_handle<CallPromise<N>> h) const noexcept
+            {
+                auto& promise = h.promise();
+                auto& list = promise.list;
+                recordLastWriter(list.nodes, list.writeMask, promise.pool_p);
+                for(std::size_t i = 0; i < list.nodes.size(); ++i)
+                {
+                    list.nodes.nodes[i]->remove_task(h, promise.pool_p);
+                }
+                auto* up = promise.parentWait;
+                // dropped after the release, the dispatching task may have returned long ago
+                auto parentFrame = std::move(promise.parent);
+                h.destroy();
+                up->release();
+            }
+
+            constexpr void await_resume() const noexcept
+            {
+            }
+        };
+
+        // promise of a dispatched plain call. Queues and resource nodes of the pool handle the call like any task,
+        // but it has no result, no shared ownership and no children. The frame frees itself once the call returned
+        template<std::size_t N>
+        struct CallPromise
+        {
+            std::atomic<uint32_t> waitCounter{INVALID_WAIT_STATE};
+            Priority priority = Priority::Normal;
+            Affinity affinity{};
+            ThreadPool* pool_p{};
+            // join counter of the dispatching task, in its frame. parent keeps the frame alive until the release
+            TaskWait* parentWait{};
+            SharedCoroutineHandle parent;
+            CallResources<N> list;
+
+            CallFrame<N> get_return_object() noexcept
+            {
+                return {std::coroutine_handle<CallPromise>::from_promise(*this)};
+            }
+
+            // published by the awaiter once the resources are ready
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            FinishCall final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void() noexcept
+            {
+            }
+
+            [[noreturn]] void unhandled_exception()
+            {
+                std::terminate();
+            }
+
+            CallResources<N>& resources() noexcept
+            {
+                return list;
+            }
+
+            static void* operator new(std::size_t n) noexcept
+            {
+                return CoroAllocator::allocate(n).ptr;
+            }
+
+            static void operator delete(void* ptr, std::size_t n) noexcept
+            {
+                CoroAllocator::deallocate({ptr, n});
+            }
+
+            static CallFrame<N> get_return_object_on_allocation_failure() noexcept
+            {
+                return {};
+            }
+        };
+
+        // the coroutine a call runs in. The callable and the arguments are kept in its frame
+        template<std::size_t N, typename Callable, typename... Stored>
+        CallFrame<N> callFrame(Callable callable, Stored... args)
+        {
+            std::invoke(callable, args...);
+            co_return;
+        }
+    } // namespace detail
+
+    // created by dispatch_call. Hooks the call up with the awaiting task and publishes it once it is ready, the
+    // awaiting task carries on without suspending
+    template<std::size_t N>
+    struct CallDispatchAwaiter
+    {
+        std::coroutine_handle<detail::CallPromise<N>> handle;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename TPromise>
+        bool await_suspend(std::coroutine_handle<TPromise> h) noexcept
+        {
+            auto& parentPromise = h.promise();
+            auto& callPromise = handle.promise();
+            auto* pool_p = parentPromise.pool();
+            auto const priority = callPromise.priority;
+            auto const affinity = callPromise.affinity;
+            auto const call = handle;
+            callPromise.pool_p = pool_p;
+            callPromise.parentWait = &parentPromise.taskWait;
+            callPromise.parent = parentPromise.self;
+            parentPromise.taskWait.add_leaf();
+            // the call could not be readied before this, so it sees its pool and parent. From here on it may run and
+            // free its frame
+            if(publishTask(callPromise))
+            {
+                pool_p->addTask(call, priority, affinity);
+            }
+            return false;
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    // co_await rg::dispatch_call(hints, callable, args...) runs callable(args...) as a task in a minimal coroutine,
+    // without the result, shared ownership and children of a Task. The callable and its arguments live in the frame,
+    // resource accesses among the arguments are registered like in dispatch_task and reach the callable as references
+    // to the data. The callable returns void, pass results through resources. Barriers of the dispatching task wait
+    // for the call
+    template<typename Callable, typename... Args>
+    auto dispatch_call(TaskHints hints, Callable&& callable, Args&&... args)
+    {
+        static_assert(
+            std::is_void_v<std::invoke_result_t<std::decay_t<Callable>&, typename detail::CallArg<Args>::type...>>,
+            "dispatch_call takes callables returning void, pass results through resources");
+
+        constexpr auto N = detail::resourceCount<Args...>;
+
+        uint16_t resourceCounter = 0;
+        auto frame = detail::callFrame<N, std::decay_t<Callable>, typename detail::CallArg<Args>::type...>(
+            std::forward<Callable>(callable),
+            process_handle(args, resourceCounter)...);
+        auto handle = frame.handle;
+        auto& promise = handle.promise();
+        promise.priority = hints.priority;
+        promise.affinity = resolveAffinity(hints.affinity);
+        promise.waitCounter.fetch_add(resourceCounter, std::memory_order_relaxed);
+        (registerAccess(handle, promise, args), ...);
+        return CallDispatchAwaiter<N>{handle};
+    }
+
+    // call dispatch in the normal priority class
+    template<typename Callable, typename... Args>
+    requires(!std::is_same_v<std::decay_t<Callable>, TaskHints>)
+    auto dispatch_call(Callable&& callable, Args&&... args)
+    {
+        return dispatch_call(TaskHints{}, std::forward<Callable>(callable), std::forward<Args>(args)...);
+    }
+} // namespace rg
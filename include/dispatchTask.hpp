@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ResourceNode.hpp"
+#include "TaskHints.hpp"
 #include "resources.hpp"
 #include "waitCounter.hpp"
 
@@ -8,20 +10,31 @@
 #include <coroutine>
 #include <cstdint>
 #include <functional>
+#include <type_traits>
 #include <utility>
 
 namespace rg
 {
-    template<typename T, bool Synchronous = false, bool finishedOnReturn = false>
+    // withResources is false if no argument of the dispatch is a resource access, the awaiter then knows at compile
+    // time that the task is ready
+    template<typename T, bool Synchronous = false, bool finishedOnReturn = false, bool withResources = true>
     struct DispatchAwaiter;
 
-    template<typename T, bool finishedOnReturn>
-    struct DispatchAwaiter<T, true, finishedOnReturn>
+    // task is ready to be eaten after the fetch sub. Until then a resource that is released cannot push the task, so
+    // the parent sets the pool and its join counter up first. If it returns true, the resources are ready and the
+    // caller is responsible to consume the task
+    template<typename TPromise>
+    bool publishTask(TPromise& promise) noexcept
+    {
+        return promise.waitCounter.fetch_sub(INVALID_WAIT_STATE, std::memory_order_acq_rel) == INVALID_WAIT_STATE;
+    }
+
+    template<typename T, bool finishedOnReturn, bool withResources>
+    struct DispatchAwaiter<T, true, finishedOnReturn, withResources>
     {
         T handle;
-        bool resourcesReady;
 
-        DispatchAwaiter(T&& handleObj, bool resReady) : handle{std::move(handleObj)}, resourcesReady{resReady}
+        explicit DispatchAwaiter(T&& handleObj) : handle{std::move(handleObj)}
         {
         }
 
@@ -35,32 +48,34 @@ namespace rg
         template<typename TPromise>
         std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> h) const noexcept
         {
-            handle.coro.template promise<typename T::promise_type>().continuationHandle = h;
-            uint32_t expectedState = 1;
-            handle.coro.template promise<typename T::promise_type>().workingState.compare_exchange_strong(
-                expectedState,
-                2);
-            // we are responsible to execute the task
-            if(resourcesReady)
+            auto& childPromise = handle.coro.template promise<typename T::promise_type>();
+            childPromise.continuationHandle = h;
+            if constexpr(!withResources)
             {
+                // nobody else knows the task yet, it is ready and not running
+                childPromise.workingState.store(2, std::memory_order_relaxed);
                 return handle.coro.get_coroutine_handle();
             }
-            // task was blocked initially and was asynchronously executed
             else
             {
+                uint32_t expectedState = 1;
+                childPromise.workingState.compare_exchange_strong(expectedState, 2);
+                // we are responsible to execute the task
+                if(publishTask(childPromise))
+                {
+                    return handle.coro.get_coroutine_handle();
+                }
+                // task was blocked initially and was asynchronously executed
                 // task was done before continuation handle was added
                 if(expectedState == 0)
                 {
                     return h;
                 }
-                else
-                {
-                    return std::noop_coroutine();
-                }
+                return std::noop_coroutine();
             }
         }
 
-        auto await_resume() const noexcept
+        auto await_resume() noexcept
         {
             if constexpr(std::is_void_v<typename T::promise_type::return_type>)
             {
@@ -68,7 +83,8 @@ namespace rg
             }
             else
             {
-                return handle.coro.template promise<typename T::promise_type>().result;
+                // nobody else can get at the result, move it out
+                return handle.take_result();
             }
         }
     };
@@ -79,24 +95,31 @@ namespace rg
     //   already added handle to waiting task map/or set waiting atomic value, return awaiter that suspend never
     //   (executes the continuation)
     // TODO switch to IsResourceAccess
-    template<typename T, bool finishedOnReturn>
-    struct DispatchAwaiter<T, false, finishedOnReturn>
+    template<typename T, bool finishedOnReturn, bool withResources>
+    struct DispatchAwaiter<T, false, finishedOnReturn, withResources>
     {
         // using ResourceAccessList
         //     = TypeList<ResourceAccess<ResourceHandles::resource_id, typename ResourceHandles::access_type>...>;
         // takes ownership of the handle, and passes it on in await resume
         T handle;
-        bool resourcesReady;
+        SpawnPolicy policy;
 
-        DispatchAwaiter(T&& handleObj, bool resReady) : handle{std::move(handleObj)}, resourcesReady{resReady}
+        explicit DispatchAwaiter(T&& handleObj, SpawnPolicy spawnPolicy = SpawnPolicy::PoolDefault)
+            : handle{std::move(handleObj)}
+            , policy{spawnPolicy}
         {
         }
 
-        bool await_ready() const noexcept
+        bool await_ready() noexcept
         {
-            // suspend if resources ready, carry on continuation without suspend if not ready
-            // suspend is false, dont suspend is true
-            return !resourcesReady;
+            if constexpr(withResources)
+            {
+                // called after await_transform of the parent hooked the child up
+                // suspend if resources ready, carry on continuation without suspend if not ready
+                // suspend is false, dont suspend is true
+                return !publishTask(handle.coro.template promise<typename T::promise_type>());
+            }
+            return false;
         }
 
         template<typename TPromise>
@@ -105,12 +128,33 @@ namespace rg
             // save here, as after dispatching self to the threadpool, this awaiter object (holding handle) may be
             // destroyed, then the return statement would be use after free
             auto resume_ready_handle = handle.coro.get_coroutine_handle();
-            auto pool_p = h.promise().pool_p;
+            auto pool_p = h.promise().pool();
+            auto& childPromise = handle.coro.template promise<typename T::promise_type>();
+            auto const childPriority = childPromise.priority;
+            auto const childAffinity = childPromise.affinity;
+            auto const runsHere = pool_p->runsHere(childAffinity);
+            // the pool has enough parallelism, run the child like a synchronous dispatch. Nothing goes through a
+            // deque, this task resumes from the final suspend of the child and the Task is done by then
+            if(runsHere && !withResources && childPriority == h.promise().priority
+               && pool_p->inlineChild(policy))
+            {
+                ThreadPool::recordStat(&WorkerCounters::tasks_inlined);
+                childPromise.continuationHandle = h;
+                childPromise.workingState.store(2, std::memory_order_relaxed);
+                return resume_ready_handle;
+            }
+            // help first, the child goes to the pool and this task carries on. A child that wants to run elsewhere
+            // is sent there the same way
+            if(!runsHere || pool_p->pushChild(policy))
+            {
+                pool_p->addTask(resume_ready_handle, childPriority, childAffinity);
+                return h;
+            }
             // suspend only called when resources are ready
             // assert(resourcesReady);
             // emplace continuation to stack
             // TODO make sure the promise of the continuation can access the return type of
-            pool_p->addTask(h);
+            pool_p->addTask(h, h.promise().priority);
 
             // execute the coroutine
             // USING THIS is dangerous cont may be finished and destroy this awitable object
@@ -138,6 +182,8 @@ namespace rg
         // TODO add return type
         auto await_resume() noexcept
         {
+            // the task is published, a SlotTask lets go of the frame here
+            handle.drop_frame();
             // return value
             return std::move(handle);
         }
@@ -168,14 +214,35 @@ namespace rg
         }
     };
 
+    // registers a dispatched task with the resource of one of its arguments, other arguments are skipped. The wait
+    // counter of the task must cover the resource already
+    template<typename TPromise, typename Access>
+    void registerAccess(std::coroutine_handle<> h, TPromise& promise, Access const& accessHandle)
+    {
+        if constexpr(HasAccessType<std::decay_t<Access>>)
+        {
+            auto const& userQueue = accessHandle.getUserQueue();
+            auto& list = promise.resources();
+            list.nodes.push_back(userQueue);
+            if(accessHandle.getAccessMode() != AccessMode::Read)
+            {
+                list.writeMask |= writeBit(list.nodes.size() - 1);
+            }
+
+            userQueue->add_task(
+                {h, accessHandle.getAccessMode(), &promise.waitCounter, promise.priority, promise.affinity});
+        }
+    }
+
     template<bool Synchronous = false, bool finishedOnReturn = false, typename Callable, typename... ResourceAccess>
-    auto dispatch_task(Callable&& callable, ResourceAccess&&... accessHandles)
+    auto dispatch_task(TaskHints hints, Callable&& callable, ResourceAccess&&... accessHandles)
     {
         // TODO bind resources with restrictions applied
         // TODO Think about copies, references and lifetimes
         // std::cout << "Counter for thread " << std::this_thread::get_id() << " is " << counter++ << std::endl;
 
         uint16_t resource_counter = 0;
+        constexpr bool withResources = (HasAccessType<std::decay_t<ResourceAccess>> || ...);
 
         // create the awaitabletask coroutine.
         auto handle = std::invoke(
@@ -184,37 +251,25 @@ namespace rg
 
         // can access coro because it this function is a friend
         auto& handlePromise = handle.coro.template promise<typename decltype(handle)::promise_type>();
-        auto& resourceNodes = handlePromise.resourceNodes;
-        auto& waitCounter = handlePromise.waitCounter;
-        // this reserves too large a space, not all accessHandles are resources
-        // resourceNodes.reserve(sizeof...(accessHandles));
-        resourceNodes.reserve(resource_counter);
-        waitCounter.fetch_add(resource_counter, std::memory_order_relaxed);
-        // Register task to resources
-        // Fold expression only for handles satisfying HasAccessType
-        (...,
-         (
-             [&resourceNodes, &handle, &waitCounter](auto const& accessHandle)
-             {
-                 if constexpr(HasAccessType<std::decay_t<decltype(accessHandle)>>)
-                 {
-                     auto const& userQueue = accessHandle.getUserQueue();
-                     resourceNodes.push_back(userQueue);
-
-                     userQueue->add_task(
-                         {handle.coro.get_coroutine_handle(), accessHandle.getAccessMode(), &waitCounter});
-                 }
-             }(std::forward<ResourceAccess>(accessHandles))));
-
-        // task is ready to be eaten after fetch sub.
-        // This is to make sure all resources are registered before someone deregistering sends this to readyQueue
-        // If it returns INVALID_WAIT_STATE, then resource are ready and we are responsible to consume it
-        auto wc = waitCounter.fetch_sub(INVALID_WAIT_STATE, std::memory_order_acq_rel);
-        bool resReady = (wc == INVALID_WAIT_STATE);
-
-        // bool resReady = (handlePromise.waitCounter.fetch_sub(INVALID_WAIT_STATE) == INVALID_WAIT_STATE);
-
-        // std::cout << "wc " << wc << " resources ready?" << resReady << std::endl;
+        // before registering, a resource may push the task as soon as it is added
+        handlePromise.priority = hints.priority;
+        handlePromise.affinity = resolveAffinity(hints.affinity);
+        // without resource accesses there is nothing to register, and the awaiter does not touch the wait counter
+        if constexpr(withResources)
+        {
+            static_assert(
+                std::decay_t<decltype(handlePromise)>::takesResources,
+                "a LightTask takes no resources, return an rg::Task instead");
+            // this reserves too large a space, not all accessHandles are resources
+            // resourceNodes.reserve(sizeof...(accessHandles));
+            handlePromise.resources().nodes.reserve(resource_counter);
+            handlePromise.waitCounter.fetch_add(resource_counter, std::memory_order_relaxed);
+            // Register task to resources
+            // Fold expression only for handles satisfying HasAccessType
+            (registerAccess(handle.coro.get_coroutine_handle(), handlePromise, accessHandles), ...);
+        }
+
+        // the awaiter drops the INVALID_WAIT_STATE offset once the parent hooked the task up, see publishTask
         // auto bound_callable = std::bind_front(std::forward<Callable>(callable), handles.obj...);
 
         //  Bind the resources as arguments to the callable/coroutine
@@ -229,13 +284,26 @@ namespace rg
         //  returns task returnHandleObject
 
         // final_suspend removes from task and notifies
-        return DispatchAwaiter<decltype(handle), Synchronous, finishedOnReturn>{std::move(handle), resReady};
+        if constexpr(Synchronous)
+        {
+            return DispatchAwaiter<decltype(handle), Synchronous, finishedOnReturn, withResources>{std::move(handle)};
+        }
+        else
+        {
+            return DispatchAwaiter<decltype(handle), Synchronous, finishedOnReturn, withResources>{
+                std::move(handle),
+                hints.spawn};
+        }
     }
 
-    // TODO Dispatch for
-    // - for short tasks, which dont need to place continuation to pool queue
-    //   if ready, do and continue; else, place task in waiters
-    // - for callables that are not rg::tasks, and dont need their own tasks space
-
-
+    // dispatch in the normal priority class
+    template<bool Synchronous = false, bool finishedOnReturn = false, typename Callable, typename... ResourceAccess>
+    requires(!std::is_same_v<std::decay_t<Callable>, TaskHints>)
+    auto dispatch_task(Callable&& callable, ResourceAccess&&... accessHandles)
+    {
+        return dispatch_task<Synchronous, finishedOnReturn>(
+            TaskHints{},
+            std::forward<Callable>(callable),
+            std::forward<ResourceAccess>(accessHandles)...);
+    }
 } // namespace rg
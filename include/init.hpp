@@ -11,7 +11,11 @@ namespace rg
     // holds the pool
     struct rg2
     {
-        rg2(std::unsigned_integral auto size) : pool{size}
+        rg2(std::unsigned_integral auto size, PoolOptions const& options = {}) : pool{size, options}
+        {
+        }
+
+        rg2(std::unsigned_integral auto size, Placement const& placement) : pool{size, placement}
         {
         }
 
@@ -24,8 +28,13 @@ namespace rg
         ThreadPool pool;
     };
 
-    auto init(std::unsigned_integral auto size) -> rg2
+    auto init(std::unsigned_integral auto size, PoolOptions const& options = {}) -> rg2
+    {
+        return {size, options};
+    }
+
+    auto init(std::unsigned_integral auto size, Placement const& placement) -> rg2
     {
-        return {size};
+        return {size, placement};
     }
 } // namespace rg
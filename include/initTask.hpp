@@ -2,13 +2,13 @@
 
 #include "FinalDelete.hpp"
 #include "SharedCoroutineHandle.hpp"
+#include "TaskWait.hpp"
 #include "ThreadPool.hpp"
 #include "dispatchTask.hpp"
 #include "waitCounter.hpp"
 
-#include <condition_variable>
+#include <atomic>
 #include <coroutine>
-#include <mutex>
 #include <optional>
 #include <utility>
 
@@ -54,6 +54,8 @@ namespace rg
 
             // initialized in await_transform of parent coroutine
             ThreadPool* pool_p{};
+            // the root always runs in the normal class
+            Priority priority = Priority::Normal;
             // does this need to be optional?
             std::optional<T> result = std::nullopt;
             // needs to be atomic. multiple threads will change this if deregistering from resources together
@@ -61,17 +63,14 @@ namespace rg
             // if .get is called and this coro is not done, add waiter handle here to notify on final suspend
             // someone else waits for the completion of this task.
             std::coroutine_handle<> continuationHandle = nullptr;
-            // mutex to synchronize final suspend and .get() waiting which adds a dependency
-            // used for barrier
-            std::mutex mtx;
-            // used for barrier
-            std::condition_variable cv;
             SharedCoroutineHandle self;
 
-            bool task_done = false;
+            // join counter for barriers on the children of the root
+            TaskWait taskWait;
+
+            // set at final suspend, get waits for it
+            std::atomic<bool> task_done{false};
             bool all_done = false;
-            // true as the return object is always created
-            bool coroOutsideTask = true;
 
             template<typename... Args>
             promise_type(ThreadPool* ptr, Args...) : pool_p{ptr}
@@ -80,6 +79,12 @@ namespace rg
                 // rootSpace->pool_p = pool_p;
             }
 
+            // the root always knows its pool, also in the compact layout of task promises
+            ThreadPool* pool() const noexcept
+            {
+                return pool_p;
+            }
+
             promise_type(promise_type const&) = delete;
             promise_type(promise_type&&) = delete;
             promise_type& operator=(promise_type const&) = delete;
@@ -109,7 +114,9 @@ namespace rg
             FinalDelete final_suspend() noexcept
             {
                 // std::cout << "final suspend called" << std::endl;
-                task_done = true;
+                taskWait.release();
+                task_done.store(true, std::memory_order_release);
+                SharedCoroutineHandle::joiners.notify_all();
                 // rootSpace.reset();
                 // notify thart work is finished here
                 // finalize
@@ -132,8 +139,8 @@ namespace rg
             }
 
             // TODO contrain args to resource concept
-            template<typename U, bool Synchronous, bool finishedOnReturn>
-            auto& await_transform(DispatchAwaiter<U, Synchronous, finishedOnReturn>& awaiter)
+            template<typename U, bool Synchronous, bool finishedOnReturn, bool withChildResources>
+            auto await_transform(DispatchAwaiter<U, Synchronous, finishedOnReturn, withChildResources>&& awaiter)
             {
                 // Init
                 auto& awaiter_promise
@@ -141,12 +148,13 @@ namespace rg
                 // pass in the parent task space
                 // coro.promise().space->parentSpace = rootSpace;
                 // pass in the pool ptr
-                awaiter_promise.pool_p = pool_p;
+                awaiter_promise.set_pool(pool_p);
 
                 // coro.promise().space->ownerHandle = coro.getHandle();
                 if constexpr(!finishedOnReturn)
                 {
                     awaiter_promise.parent = self;
+                    taskWait.add_child(awaiter_promise.taskWait);
                 }
 
                 // Init over
@@ -156,11 +164,11 @@ namespace rg
                 // elseif resources not ready
                 //   task has been initialized with wait counter, waits for child notification to add to ready queue
                 //   return awaiter that suspend never (executes the continuation)
-                return awaiter;
+                return std::move(awaiter);
             }
 
             template<typename NonDispatchAwaiter>
-            auto await_transform(NonDispatchAwaiter&& aw)
+            decltype(auto) await_transform(NonDispatchAwaiter&& aw)
             {
                 return std::forward<NonDispatchAwaiter>(aw);
             }
@@ -178,90 +186,43 @@ namespace rg
 
         InitTask& operator=(InitTask&& x) = delete;
 
+        // the owning thread helps the pool until the root and every task holding it are done
         ~InitTask() noexcept
         {
             if(coro)
             {
-                // wait for task end, wait for root space to finish
-                // if(coro.use_count() == 1)
-                // {
-                //     coro.reset();
-                // }
-                // if(coro.use_count() > 1)
-                // {
-                //     std::unique_lock lock(coro.promise<promise_type>().mtx);
-                //     std::cout << "finalize locked. Task done : " << coro.promise<promise_type>().task_done
-                //               << "child counter : " << coro.promise<promise_type>().childCounter << std::endl;
-                //     coro.promise<promise_type>().cv.wait(
-                //         lock,
-                //         [this] {
-                //             return coro.promise<promise_type>().task_done
-                //                    && coro.promise<promise_type>().childCounter == 0;
-                //         });
-                // }
-                // std::cout << "finalize called with use count : " << coro.use_count() << std::endl;
-                //
-                // auto backoff_time = std::chrono::microseconds(1); // Initial backoff time
-                // auto const max_backoff_time = std::chrono::milliseconds(10); // Maximum backoff time
-
-                // This handle holds one copy of coro
-                while(*coro.use_count_ptr() > 1)
-                {
-                    // if(backoff_time < max_backoff_time)
-                    // {
-                    //     std::this_thread::sleep_for(backoff_time);
-                    //     backoff_time *= 2;
-                    // }
-                    // else
-                    {
-                        std::this_thread::yield();
-                    }
-                }
-
-                // while(coro.use_count() > 1)
-                // {
-                //     std::this_thread::sleep_for(std::chrono::seconds(3));
-                //     // std::cout << "use count : " << coro.use_count() << std::endl;
-                // }
-                coro.promise<promise_type>().coroOutsideTask = false;
+                join();
                 coro.reset();
-
-                // {
-                //     std::unique_lock lock(coro.promise<promise_type>().mtx);
-                //     coro.promise<promise_type>().cv.wait(
-                //         lock,
-                //         [this] { return coro.promise<promise_type>().childCounter == 0; });
-                // }
-                // {
-                //     std::unique_lock lock(coro.promise().rootSpace->mtx);
-                //     // maybe better to set a done bool in the execution space rather that checking empty resList
-                //     coro.promise().rootSpace->cv.wait(lock, [this] { return coro.promise().rootSpace->done(); });
-                // }
             }
         }
 
+        // helps the pool until the root returned, its children may still be running
         std::optional<T> get()
         {
-            // sleep till final suspend notifies
-            // coro.done() is check for spurious wakeups
-            // can also spin on coro.done, may be easier
-            // while(!coro.done){} return coro.promise().result;
-            if(!coro.promise<promise_type>().task_done)
-            {
-                std::unique_lock lock(coro.promise<promise_type>().mtx);
-                coro.promise<promise_type>().cv.wait(lock, [this] { return coro.promise<promise_type>().task_done; });
-                // todo make this exception safe
-            }
-            auto result = coro.promise<promise_type>().result.value();
-
-            // coro.destroy();
-            // make sure coro isnt used again by the handle. Either destroyed or owned by the execution space
-            // coro = nullptr;
-            return result;
+            auto& promise = coro.promise<promise_type>();
+            promise.pool_p->helpUntil(
+                [&promise] { return promise.task_done.load(std::memory_order_acquire); },
+                SharedCoroutineHandle::joiners);
+            return promise.result.value();
         }
 
     private:
         SharedCoroutineHandle coro;
+
+        // until this handle is the last one to the frame
+        void join()
+        {
+            if(coro.sole_owner())
+            {
+                return;
+            }
+            auto& count = *coro.use_count_ptr();
+            count.fetch_or(SharedCoroutineHandle::joinFlag, std::memory_order_acq_rel);
+            coro.promise<promise_type>().pool_p->helpUntil(
+                [this] { return coro.sole_owner(); },
+                SharedCoroutineHandle::joiners);
+            count.fetch_and(~SharedCoroutineHandle::joinFlag, std::memory_order_acq_rel);
+        }
     };
 
     // TODO also make initTask and orchestrate for void
@@ -0,0 +1,410 @@
+#pragma once
+
+#include "Task.hpp"
+#include "TaskHints.hpp"
+#include "ThreadPool.hpp"
+#include "barrier.hpp"
+#include "dispatchTask.hpp"
+#include "submit.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rg
+{
+    namespace detail
+    {
+        // splits go to the deque of the splitting worker, where idle workers steal them
+        inline constexpr TaskHints splitHints{Priority::Normal, SpawnPolicy::ChildStealing, {}};
+
+        // grain used when the caller passes 0, leaves about 8 chunks per worker. Outside of a pool the cores stand in
+        // for the workers
+        inline std::size_t autoGrain(std::size_t n) noexcept
+        {
+            auto* pool_p = ThreadPool::current_pool();
+            std::size_t workers = pool_p ? pool_p->max_worker_count() : std::thread::hardware_concurrency();
+            return std::max<std::size_t>(1, n / (8 * std::max<std::size_t>(workers, 1)));
+        }
+
+        inline std::size_t grainFor(std::size_t grain, std::size_t n) noexcept
+        {
+            return grain == 0 ? autoGrain(n) : grain;
+        }
+
+        // lazy binary splitting: runs body over chunks of grain elements and only splits off the upper half of what
+        // is left while the deque of the worker is empty. A busy pool runs the range like a serial loop, an idle one
+        // gets log(n) splits per thief. Returns once the range and all of its splits are done
+        template<typename It, typename Body>
+        auto splitRange(It first, It last, std::size_t grain, Body const* body) -> LightTask<void>
+        {
+            while(static_cast<std::size_t>(last - first) > grain)
+            {
+                if(static_cast<std::size_t>(last - first) >= 2 * grain && ThreadPool::split_wanted())
+                {
+                    auto mid = first + (last - first) / 2;
+                    co_await dispatch_task(splitHints, splitRange<It, Body>, mid, last, grain, body);
+                    last = mid;
+                }
+                else
+                {
+                    (*body)(first, first + grain);
+                    first += grain;
+                }
+            }
+            (*body)(first, last);
+            co_await BarrierAwaiter{};
+        }
+
+        // owns the body while the range runs. body(first, last) handles one chunk
+        template<typename It, typename Body>
+        auto rangeRoot(It first, It last, std::size_t grain, Body body) -> LightTask<void>
+        {
+            if(first != last)
+            {
+                co_await dispatch_task<true, true>(
+                    splitRange<It, Body>,
+                    first,
+                    last,
+                    grainFor(grain, static_cast<std::size_t>(last - first)),
+                    &body);
+            }
+        }
+
+        // like splitRange, the splits hand their partial results back. Partial results are combined in the order of
+        // the range, op only has to be associative. The range is not empty
+        template<typename It, typename T, typename Op>
+        auto reduceRange(It first, It last, std::size_t grain, Op const* op) -> LightTask<T>
+        {
+            std::vector<LightTask<T>> splits;
+            auto chunkEnd = std::ranges::next(first, static_cast<std::ptrdiff_t>(grain), last);
+            T acc = *first;
+            for(++first; first != chunkEnd; ++first)
+            {
+                acc = (*op)(std::move(acc), *first);
+            }
+            while(first != last)
+            {
+                if(static_cast<std::size_t>(last - first) >= 2 * grain && ThreadPool::split_wanted())
+                {
+                    auto mid = first + (last - first) / 2;
+                    splits.push_back(co_await dispatch_task(splitHints, reduceRange<It, T, Op>, mid, last, grain, op));
+                    last = mid;
+                }
+                else
+                {
+                    chunkEnd = std::ranges::next(first, static_cast<std::ptrdiff_t>(grain), last);
+                    for(; first != chunkEnd; ++first)
+                    {
+                        acc = (*op)(std::move(acc), *first);
+                    }
+                }
+            }
+            // the last split covers the lowest part of the rest
+            for(auto split = splits.rbegin(); split != splits.rend(); ++split)
+            {
+                acc = (*op)(std::move(acc), co_await split->get());
+            }
+            co_return acc;
+        }
+
+        template<typename It, typename T, typename Op>
+        auto reduceRoot(It first, It last, T init, Op op, std::size_t grain) -> LightTask<T>
+        {
+            if(first == last)
+            {
+                co_return init;
+            }
+            auto partial = co_await dispatch_task<true, true>(
+                reduceRange<It, T, Op>,
+                first,
+                last,
+                grainFor(grain, static_cast<std::size_t>(last - first)),
+                &op);
+            co_return op(std::move(init), std::move(partial));
+        }
+
+        // two passes over fixed blocks: the sums of all blocks in parallel, a serial scan over the sums, then the
+        // scan of every block from its offset in parallel
+        template<typename It, typename OutIt, typename Op>
+        auto scanRoot(It first, It last, OutIt d_first, Op op, std::size_t grain) -> LightTask<void>
+        {
+            using T = std::iter_value_t<It>;
+            auto const n = static_cast<std::size_t>(last - first);
+            if(n == 0)
+            {
+                co_return;
+            }
+            auto const block = grainFor(grain, n);
+            auto const blockCount = (n + block - 1) / block;
+            auto blockFirst = [&](std::size_t b) { return first + static_cast<std::ptrdiff_t>(b * block); };
+            auto blockLast
+                = [&](std::size_t b) { return first + static_cast<std::ptrdiff_t>(std::min(n, (b + 1) * block)); };
+
+            std::vector<T> sums(blockCount);
+            auto blocks = std::views::iota(std::size_t{0}, blockCount);
+            auto sumBlocks = [&](auto b, auto e)
+            {
+                // the last block never contributes to an offset
+                for(; b != e; ++b)
+                {
+                    if(*b + 1 < blockCount)
+                    {
+                        auto it = blockFirst(*b);
+                        sums[*b] = std::reduce(std::next(it), blockLast(*b), T(*it), op);
+                    }
+                }
+            };
+            co_await dispatch_task<true, true>(
+                splitRange<decltype(blocks.begin()), decltype(sumBlocks)>,
+                blocks.begin(),
+                blocks.end(),
+                std::size_t{1},
+                &sumBlocks);
+
+            // sums[b] becomes the offset of block b + 1
+            std::inclusive_scan(sums.begin(), sums.end(), sums.begin(), op);
+
+            auto scanBlocks = [&](auto b, auto e)
+            {
+                for(; b != e; ++b)
+                {
+                    auto out = d_first + static_cast<std::ptrdiff_t>(*b * block);
+                    if(*b == 0)
+                    {
+                        std::inclusive_scan(blockFirst(*b), blockLast(*b), out, op);
+                    }
+                    else
+                    {
+                        std::inclusive_scan(blockFirst(*b), blockLast(*b), out, op, sums[*b - 1]);
+                    }
+                }
+            };
+            co_await dispatch_task<true, true>(
+                splitRange<decltype(blocks.begin()), decltype(scanBlocks)>,
+                blocks.begin(),
+                blocks.end(),
+                std::size_t{1},
+                &scanBlocks);
+        }
+
+        // quicksort that hands the smaller side of every partition to the pool and keeps the larger one, so a task
+        // never holds more than log(n) pending sides. Ranges up to grain, and ranges whose partitions keep coming out
+        // lopsided, go to std::sort
+        template<typename It, typename Compare>
+        auto sortRange(It first, It last, std::size_t grain, Compare const* comp, int depth) -> LightTask<void>
+        {
+            while(static_cast<std::size_t>(last - first) > grain && depth-- > 0)
+            {
+                auto mid = first + (last - first) / 2;
+                auto a = *first;
+                auto b = *mid;
+                auto c = *std::prev(last);
+                // median of three
+                auto pivot = (*comp)(a, b) ? ((*comp)(b, c) ? b : ((*comp)(a, c) ? c : a))
+                                           : ((*comp)(a, c) ? a : ((*comp)(b, c) ? c : b));
+                // three way, so runs of equal keys drop out instead of degrading the partitions
+                auto lower = std::partition(first, last, [&](auto const& x) { return (*comp)(x, pivot); });
+                auto upper = std::partition(lower, last, [&](auto const& x) { return !(*comp)(pivot, x); });
+                if(lower - first < last - upper)
+                {
+                    if(lower - first > 1)
+                    {
+                        co_await dispatch_task(splitHints, sortRange<It, Compare>, first, lower, grain, comp, depth);
+                    }
+                    first = upper;
+                }
+                else
+                {
+                    if(last - upper > 1)
+                    {
+                        co_await dispatch_task(splitHints, sortRange<It, Compare>, upper, last, grain, comp, depth);
+                    }
+                    last = lower;
+                }
+            }
+            std::sort(first, last, *comp);
+            co_await BarrierAwaiter{};
+        }
+
+        template<typename It, typename Compare>
+        auto sortRoot(It first, It last, Compare comp, std::size_t grain) -> LightTask<void>
+        {
+            auto const n = static_cast<std::size_t>(last - first);
+            if(n > 1)
+            {
+                co_await dispatch_task<true, true>(
+                    sortRange<It, Compare>,
+                    first,
+                    last,
+                    grain == 0 ? std::max<std::size_t>(autoGrain(n), 256) : grain,
+                    &comp,
+                    2 * static_cast<int>(std::bit_width(n)));
+            }
+        }
+    } // namespace detail
+
+    // Parallel algorithms for tasks. co_await one of them from a task, it runs the range on the calling worker and
+    // hands parts of it to idle workers, and resumes once the whole range is done. grain is the number of elements
+    // handled between two checks for idle workers, and the smallest part that is handed out; 0 picks one from the
+    // size of the range and of the pool. The iterators have to be random access and stay valid until the algorithm
+    // is done. Passing resources is not supported, access them through the task that runs the algorithm
+
+    // f(*it) for every element
+    template<std::random_access_iterator It, typename F>
+    auto parallel_for(It first, It last, F f, std::size_t grain = 0)
+    {
+        auto body = [f = std::move(f)](It b, It e)
+        {
+            for(; b != e; ++b)
+            {
+                f(*b);
+            }
+        };
+        return dispatch_task<true, true>(detail::rangeRoot<It, decltype(body)>, first, last, grain, std::move(body));
+    }
+
+    // *(d_first + i) = op(*(first + i)), like std::transform
+    template<std::random_access_iterator It, std::random_access_iterator OutIt, typename Op>
+    auto transform(It first, It last, OutIt d_first, Op op, std::size_t grain = 0)
+    {
+        auto body = [first, d_first, op = std::move(op)](It b, It e)
+        {
+            for(auto out = d_first + (b - first); b != e; ++b, ++out)
+            {
+                *out = op(*b);
+            }
+        };
+        return dispatch_task<true, true>(detail::rangeRoot<It, decltype(body)>, first, last, grain, std::move(body));
+    }
+
+    // combines init and all elements with op, like std::reduce. Results are combined in the order of the range, op
+    // only has to be associative
+    template<std::random_access_iterator It, typename T, typename Op = std::plus<>>
+    auto reduce(It first, It last, T init, Op op = {}, std::size_t grain = 0)
+    {
+        return dispatch_task<true, true>(
+            detail::reduceRoot<It, T, Op>,
+            first,
+            last,
+            std::move(init),
+            std::move(op),
+            grain);
+    }
+
+    // like std::inclusive_scan. grain is the size of the blocks of the two passes, the input is read twice
+    template<std::random_access_iterator It, std::random_access_iterator OutIt, typename Op = std::plus<>>
+    auto inclusive_scan(It first, It last, OutIt d_first, Op op = {}, std::size_t grain = 0)
+    {
+        return dispatch_task<true, true>(detail::scanRoot<It, OutIt, Op>, first, last, d_first, std::move(op), grain);
+    }
+
+    // unstable sort, like std::sort
+    template<std::random_access_iterator It, typename Compare = std::less<>>
+    auto sort(It first, It last, Compare comp = {}, std::size_t grain = 0)
+    {
+        return dispatch_task<true, true>(detail::sortRoot<It, Compare>, first, last, std::move(comp), grain);
+    }
+
+    namespace execution
+    {
+        // runs an algorithm of this header on a pool from a thread outside of it and blocks until it is done, the
+        // counterpart of std::execution::par. Do not use it from a worker, co_await the algorithm there instead
+        struct PoolPolicy
+        {
+            ThreadPool* pool_p;
+        };
+
+        inline PoolPolicy par(ThreadPool* pool_p) noexcept
+        {
+            return PoolPolicy{pool_p};
+        }
+    } // namespace execution
+
+    template<std::random_access_iterator It, typename F>
+    void for_each(execution::PoolPolicy policy, It first, It last, F f, std::size_t grain = 0)
+    {
+        submit(
+            policy.pool_p,
+            [](It b, It e, F fn, std::size_t g) -> LightTask<void>
+            { co_await rg::parallel_for(b, e, std::move(fn), g); },
+            first,
+            last,
+            std::move(f),
+            grain)
+            .get();
+    }
+
+    template<std::random_access_iterator It, std::random_access_iterator OutIt, typename Op>
+    OutIt transform(execution::PoolPolicy policy, It first, It last, OutIt d_first, Op op, std::size_t grain = 0)
+    {
+        submit(
+            policy.pool_p,
+            [](It b, It e, OutIt out, Op fn, std::size_t g) -> LightTask<void>
+            { co_await rg::transform(b, e, out, std::move(fn), g); },
+            first,
+            last,
+            d_first,
+            std::move(op),
+            grain)
+            .get();
+        return d_first + (last - first);
+    }
+
+    template<std::random_access_iterator It, typename T, typename Op = std::plus<>>
+    T reduce(execution::PoolPolicy policy, It first, It last, T init, Op op = {}, std::size_t grain = 0)
+    {
+        return submit(
+                   policy.pool_p,
+                   [](It b, It e, T i, Op fn, std::size_t g) -> LightTask<T>
+                   { co_return co_await rg::reduce(b, e, std::move(i), std::move(fn), g); },
+                   first,
+                   last,
+                   std::move(init),
+                   std::move(op),
+                   grain)
+            .get();
+    }
+
+    template<std::random_access_iterator It, std::random_access_iterator OutIt, typename Op = std::plus<>>
+    OutIt inclusive_scan(
+        execution::PoolPolicy policy,
+        It first,
+        It last,
+        OutIt d_first,
+        Op op = {},
+        std::size_t grain = 0)
+    {
+        submit(
+            policy.pool_p,
+            [](It b, It e, OutIt out, Op fn, std::size_t g) -> LightTask<void>
+            { co_await rg::inclusive_scan(b, e, out, std::move(fn), g); },
+            first,
+            last,
+            d_first,
+            std::move(op),
+            grain)
+            .get();
+        return d_first + (last - first);
+    }
+
+    template<std::random_access_iterator It, typename Compare = std::less<>>
+    void sort(execution::PoolPolicy policy, It first, It last, Compare comp = {}, std::size_t grain = 0)
+    {
+        submit(
+            policy.pool_p,
+            [](It b, It e, Compare c, std::size_t g) -> LightTask<void> { co_await rg::sort(b, e, std::move(c), g); },
+            first,
+            last,
+            std::move(comp),
+            grain)
+            .get();
+    }
+} // namespace rg
@@ -37,4 +37,14 @@ namespace rg
             return UINT32_MAX;
         }
     };
+
+    // spreads one base seed over independent streams, e.g. one per worker. Never returns 0
+    inline constexpr uint32_t mixSeed(uint32_t seed, uint32_t stream) noexcept
+    {
+        uint32_t z = seed + 0x9e37'79b9u * (stream + 1u);
+        z = (z ^ (z >> 16)) * 0x85eb'ca6bu;
+        z = (z ^ (z >> 13)) * 0xc2b2'ae35u;
+        z ^= z >> 16;
+        return z == 0 ? 1u : z;
+    }
 } // namespace rg
@@ -1,9 +1,16 @@
 #pragma once
 
+#include "Arena.hpp"
 #include "Task.hpp"
 #include "ThreadPool.hpp"
 #include "barrier.hpp"
+#include "dispatchBulk.hpp"
+#include "dispatchCall.hpp"
 #include "dispatchTask.hpp"
 #include "init.hpp"
 #include "initTask.hpp"
+#include "parallel.hpp"
 #include "resources.hpp"
+#include "sleep.hpp"
+#include "submit.hpp"
+#include "yield.hpp"
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <type_traits>
+
+namespace rg
+{
+    // suspends the task until deadline without holding its worker. The pool keeps the task in its timer wheel and
+    // pushes it to the deque of the worker that finds it expired, in the class of the task
+    struct SleepAwaiter
+    {
+        std::chrono::steady_clock::time_point deadline;
+
+        bool await_ready() const noexcept
+        {
+            return deadline <= std::chrono::steady_clock::now();
+        }
+
+        template<typename TPromise>
+        bool await_suspend(std::coroutine_handle<TPromise> h)
+        {
+            return h.promise().pool()->addTimer(h, h.promise().priority, deadline);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    template<typename Rep, typename Period>
+    SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration)
+    {
+        return {std::chrono::steady_clock::now()
+                + std::chrono::ceil<std::chrono::steady_clock::duration>(duration)};
+    }
+
+    template<typename Clock, typename Duration>
+    SleepAwaiter sleep_until(std::chrono::time_point<Clock, Duration> deadline)
+    {
+        if constexpr(std::is_same_v<Clock, std::chrono::steady_clock>)
+        {
+            return {std::chrono::time_point_cast<std::chrono::steady_clock::duration>(deadline)};
+        }
+        else
+        {
+            return sleep_for(deadline - Clock::now());
+        }
+    }
+} // namespace rg
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Priority.hpp"
+#include "Task.hpp"
+#include "TaskHints.hpp"
+#include "ThreadPool.hpp"
+#include "barrier.hpp"
+#include "dispatchTask.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace rg
+{
+    namespace detail
+    {
+        // shared by the handle of the submitter and the root task running the submitted callable
+        template<typename T>
+        struct SubmitState
+        {
+            static constexpr uint32_t pending = 0;
+            // a coroutine is suspended on the handle
+            static constexpr uint32_t awaited = 1;
+            static constexpr uint32_t done = 2;
+
+            std::atomic<uint32_t> state{pending};
+            // coroutine awaiting the result, and the pool to resume it on
+            std::coroutine_handle<> awaiter{};
+            ThreadPool* awaiterPool{};
+            Priority awaiterPriority = Priority::Normal;
+            std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+
+            // called once by the root after the result is stored
+            void complete() noexcept
+            {
+                if(state.exchange(done, std::memory_order_acq_rel) == awaited)
+                {
+                    awaiterPool->addTask(awaiter, awaiterPriority);
+                }
+                state.notify_all();
+            }
+        };
+
+        // return type of the task the callable creates when called with the processed args
+        template<typename Callable, typename... Args>
+        using submit_result_t = typename decltype(std::invoke(
+            std::declval<Callable&>(),
+            process_handle(std::declval<Args&>(), std::declval<uint16_t&>())...))::promise_type::return_type;
+
+        // root of a submitted task. Runs on a worker, so the resources are registered by the pool and not by the
+        // submitting thread
+        template<typename T, typename Callable, typename... Args>
+        auto submitRoot(std::shared_ptr<SubmitState<T>> state, TaskHints hints, Callable callable, Args... args)
+            -> LightTask<void>
+        {
+            auto task = co_await dispatch_task(hints, callable, args...);
+            if constexpr(std::is_void_v<T>)
+            {
+                // void tasks have no get, wait for the subtree of the root instead
+                co_await BarrierAwaiter{};
+                state->result.emplace(true);
+            }
+            else
+            {
+                state->result.emplace(co_await task.get());
+            }
+            state->complete();
+            co_return;
+        }
+    } // namespace detail
+
+    // result of a task submitted from outside the pool. Either block on it with get, or co_await it from a task of
+    // any pool. The result can only be taken once
+    template<typename T>
+    struct SubmitHandle
+    {
+        explicit SubmitHandle(std::shared_ptr<detail::SubmitState<T>> state) noexcept : state_p{std::move(state)}
+        {
+        }
+
+        bool ready() const noexcept
+        {
+            return state_p->state.load(std::memory_order_acquire) == detail::SubmitState<T>::done;
+        }
+
+        // blocks the calling thread until the task is done. Do not call it from a worker, it would stop the worker
+        // from running the task it waits for
+        void wait() const noexcept
+        {
+            auto current = state_p->state.load(std::memory_order_acquire);
+            while(current != detail::SubmitState<T>::done)
+            {
+                state_p->state.wait(current, std::memory_order_acquire);
+                current = state_p->state.load(std::memory_order_acquire);
+            }
+        }
+
+        T get()
+        {
+            wait();
+            return take();
+        }
+
+        bool await_ready() const noexcept
+        {
+            return ready();
+        }
+
+        // the root reschedules h on the pool of the awaiting task
+        template<typename TPromise>
+        bool await_suspend(std::coroutine_handle<TPromise> h) noexcept
+        {
+            state_p->awaiter = h;
+            state_p->awaiterPool = h.promise().pool();
+            state_p->awaiterPriority = h.promise().priority;
+            auto expected = detail::SubmitState<T>::pending;
+            // fails only if the task completed in the meantime
+            return state_p->state.compare_exchange_strong(
+                expected,
+                detail::SubmitState<T>::awaited,
+                std::memory_order_acq_rel,
+                std::memory_order_acquire);
+        }
+
+        T await_resume()
+        {
+            return take();
+        }
+
+    private:
+        T take()
+        {
+            if constexpr(!std::is_void_v<T>)
+            {
+                return std::move(*state_p->result);
+            }
+        }
+
+        std::shared_ptr<detail::SubmitState<T>> state_p;
+    };
+
+    // runs the callable as a task of the pool. Safe to call from any thread, threads that are not workers of the pool
+    // go through its injection queue
+    template<typename Callable, typename... Args>
+    auto submit(ThreadPool* pool_p, TaskHints hints, Callable&& callable, Args&&... args)
+    {
+        using T = detail::submit_result_t<std::decay_t<Callable>, std::decay_t<Args>...>;
+        auto state = std::make_shared<detail::SubmitState<T>>();
+        auto root = detail::submitRoot<T>(state, hints, std::forward<Callable>(callable), std::forward<Args>(args)...);
+
+        // not dispatched through await_transform, pass in the pool ptr here
+        auto& rootPromise = root.coro.template promise<typename decltype(root)::promise_type>();
+        rootPromise.set_pool(pool_p);
+        rootPromise.priority = hints.priority;
+        pool_p->addTask(root.coro.get_coroutine_handle(), hints.priority);
+        return SubmitHandle<T>{std::move(state)};
+    }
+
+    // submit in the normal priority class
+    template<typename Callable, typename... Args>
+    requires(!std::is_same_v<std::decay_t<Callable>, TaskHints>)
+    auto submit(ThreadPool* pool_p, Callable&& callable, Args&&... args)
+    {
+        return submit(pool_p, TaskHints{}, std::forward<Callable>(callable), std::forward<Args>(args)...);
+    }
+} // namespace rg
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include <coroutine>
+
+namespace rg
+{
+    // gives the worker back to the scheduler. The task continues on the same worker once that worker found nothing
+    // else in its own deque, its inbox, the injection queue or the deques of its victims. With onlyIfWanted the
+    // task keeps the worker unless a higher class, a task routed to this worker or unclaimed submitted work waits
+    struct YieldAwaiter
+    {
+        bool onlyIfWanted = false;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename TPromise>
+        bool await_suspend(std::coroutine_handle<TPromise> h)
+        {
+            auto& promise = h.promise();
+            if(onlyIfWanted && !promise.pool()->yieldWanted(promise.priority))
+            {
+                return false;
+            }
+            promise.pool()->yieldTask(h, promise.priority);
+            return true;
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    // co_await rg::yield(); in a long running task lets the other work of its worker run first
+    inline YieldAwaiter yield() noexcept
+    {
+        return {};
+    }
+
+    // cheap enough to call in a loop, only suspends when yieldWanted says so
+    inline YieldAwaiter yield_if_needed() noexcept
+    {
+        return {true};
+    }
+} // namespace rg
@@ -0,0 +1,62 @@
+// A plain call dispatched with dispatch_call releases the join counter of its parent when it is done. The parent may
+// return long before that, so the call has to keep the frame of the parent alive like a coroutine child does.
+
+#include <rg.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+static int failures = 0;
+
+void check(char const* name, bool passed)
+{
+    std::printf("  - %s: %s\n", name, passed ? "passed" : "FAILED");
+    failures += passed ? 0 : 1;
+}
+
+struct Outcome
+{
+    std::atomic<bool> done{false};
+    // the frame of the parent still existed when the call finished
+    bool parentAlive = false;
+};
+
+void slowCall(std::weak_ptr<int> parentFrame, Outcome* outcome)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    outcome->parentAlive = !parentFrame.expired();
+    outcome->done.store(true, std::memory_order_release);
+}
+
+// returns right after the dispatch, without a barrier. token lives in the frame and dies with it
+auto parent(std::shared_ptr<int> token, Outcome* outcome) -> rg::LightTask<int>
+{
+    // a frame well beyond the small blocks of the frame allocator
+    std::array<char, 1024> scratch;
+    scratch.fill(1);
+    co_await rg::dispatch_call(slowCall, std::weak_ptr<int>{token}, outcome);
+    co_return std::accumulate(scratch.begin(), scratch.end(), 0);
+}
+
+int main()
+{
+    auto poolObj = rg::init(4u, rg::PoolOptions{rg::Placement::compact(true)});
+    Outcome outcome;
+
+    std::printf("call_parent:\n");
+    auto result = rg::submit(poolObj.pool_ptr(), parent, std::make_shared<int>(0), &outcome).get();
+    check("parent_returned", result == 1024);
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(!outcome.done.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    check("call_done", outcome.done.load(std::memory_order_acquire));
+    check("parent_alive", outcome.parentAlive);
+    return failures == 0 ? 0 : 1;
+}
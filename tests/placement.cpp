@@ -0,0 +1,46 @@
+// Explicit placements are checked in the pool constructor, on the calling thread. Cpusets that are empty or name
+// hardware threads the process may not run on are rejected there and never reach the workers.
+
+#include <rg.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+static int failures = 0;
+
+void check(char const* name, bool passed)
+{
+    std::printf("  - %s: %s\n", name, passed ? "passed" : "FAILED");
+    failures += passed ? 0 : 1;
+}
+
+bool rejects(rg::Placement const& placement)
+{
+    try
+    {
+        rg::ThreadPool pool(1u, placement);
+    }
+    catch(std::runtime_error const&)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    auto const allowed = hwloc_topology_get_allowed_cpuset(rg::HwlocTopology::getInstance());
+    auto const firstPU = static_cast<unsigned>(hwloc_bitmap_first(allowed));
+    // past the last allowed hardware thread
+    auto const unknownPU = static_cast<unsigned>(hwloc_bitmap_last(allowed)) + 1;
+
+    std::printf("placement:\n");
+    check("empty_cpuset", rejects(rg::Placement::explicitCpusets({{}})));
+    check("unknown_pu", rejects(rg::Placement::explicitCpusets({{unknownPU}})));
+    check("unknown_pu_in_set", rejects(rg::Placement::explicitCpusets({{firstPU, unknownPU}})));
+    // sets beyond the worker count are checked as well
+    check("empty_unused_cpuset", rejects(rg::Placement::explicitCpusets({{firstPU}, {}})));
+    check("allowed_pu", !rejects(rg::Placement::explicitCpusets({{firstPU}})));
+    return failures == 0 ? 0 : 1;
+}
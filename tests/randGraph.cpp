@@ -13,11 +13,6 @@
 #include <vector>
 using namespace std::chrono;
 
-void sleep(std::chrono::microseconds d)
-{
-    std::this_thread::sleep_for(d);
-}
-
 void hash(unsigned task_id, std::array<uint64_t, 8>& val)
 {
     val[0] += task_id;
@@ -113,7 +108,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, false>(
                     []() -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         co_return;
                     });
                 break;
@@ -123,7 +118,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, true>(
                     [](auto ra1, auto i) -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         hash(i, *ra1);
                         co_return;
                     },
@@ -136,7 +131,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, true>(
                     [](auto ra1, auto ra2, auto i) -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         hash(i, *ra1);
                         hash(i, *ra2);
                         co_return;
@@ -151,7 +146,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, true>(
                     [](auto ra1, auto ra2, auto ra3, auto i) -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         hash(i, *ra1);
                         hash(i, *ra2);
                         hash(i, *ra3);
@@ -168,7 +163,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, true>(
                     [](auto ra1, auto ra2, auto ra3, auto ra4, auto i) -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         hash(i, *ra1);
                         hash(i, *ra2);
                         hash(i, *ra3);
@@ -187,7 +182,7 @@ auto test([[maybe_unused]] rg::ThreadPool* ptr) -> rg::InitTask<int>
                 co_await rg::dispatch_task<false, true>(
                     [](auto ra1, auto ra2, auto ra3, auto ra4, auto ra5, auto i) -> rg::Task<void>
                     {
-                        sleep(task_duration);
+                        co_await rg::sleep_for(task_duration);
                         hash(i, *ra1);
                         hash(i, *ra2);
                         hash(i, *ra3);
@@ -0,0 +1,86 @@
+// Tasks readied by a resource are routed to the worker that last wrote it. That worker may be busy for a long time,
+// so the routed task has to stay within reach of the idle workers: a busy last writer must not hold it up.
+
+#include <rg.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+static int failures = 0;
+
+void check(char const* name, bool passed)
+{
+    std::printf("  - %s: %s\n", name, passed ? "passed" : "FAILED");
+    failures += passed ? 0 : 1;
+}
+
+struct Times
+{
+    std::atomic<int> readerSaw{0};
+    std::atomic<Clock::rep> readerDone{0};
+    std::atomic<Clock::rep> writerStart{0};
+};
+
+auto firstWriter(int& value) -> rg::Task<void>
+{
+    value = 1;
+    co_return;
+}
+
+// keeps the last writer busy long after its write
+auto spin() -> rg::LightTask<void>
+{
+    auto const end = Clock::now() + std::chrono::milliseconds(300);
+    while(Clock::now() < end)
+    {
+    }
+    co_return;
+}
+
+auto reader(int const& value, Times* times) -> rg::Task<void>
+{
+    times->readerSaw.store(value, std::memory_order_relaxed);
+    times->readerDone.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+    co_return;
+}
+
+// readied by the reader on another worker, routed to the busy first writer
+auto secondWriter(int& value, Times* times) -> rg::Task<void>
+{
+    times->writerStart.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+    value = 2;
+    co_return;
+}
+
+auto root(Times* times) -> rg::LightTask<void>
+{
+    rg::Resource<int> value;
+    rg::TaskHints onFirst{};
+    onFirst.affinity = rg::Affinity::worker(1);
+    rg::TaskHints onSecond{};
+    onSecond.affinity = rg::Affinity::worker(2);
+    // the inbox of worker 1 runs in order, spin starts once the first write is done
+    co_await rg::dispatch_task(onFirst, firstWriter, value.rg_write());
+    co_await rg::dispatch_task(onFirst, spin);
+    co_await rg::dispatch_task(onSecond, reader, value.rg_read(), times);
+    co_await rg::dispatch_task(secondWriter, value.rg_write(), times);
+    co_await rg::BarrierAwaiter{};
+}
+
+int main()
+{
+    auto poolObj = rg::init(4u, rg::PoolOptions{rg::Placement::compact(true)});
+    Times times;
+
+    std::printf("routing:\n");
+    rg::submit(poolObj.pool_ptr(), root, &times).get();
+    auto const delay = Clock::duration(times.writerStart.load() - times.readerDone.load());
+    check("reader_after_first_writer", times.readerSaw.load() == 1);
+    check("writer_after_reader", delay >= Clock::duration::zero());
+    // well below the 300 ms the last writer stays busy
+    check("busy_last_writer_bypassed", delay < std::chrono::milliseconds(150));
+    return failures == 0 ? 0 : 1;
+}